@@ -4,11 +4,104 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <math.h>
+#include <float.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SIMD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+    #define SIMD_NEON
+#endif
+
+#ifndef MAX_WINDOWS
 #define MAX_WINDOWS (16)
+#endif
+#ifndef MAX_ANIMATIONS
+#define MAX_ANIMATIONS (32)
+#endif
+#define WINDOW_TABLE_SIZE (MAX_WINDOWS * 2)
 #define STRING_BUFFER_SIZE (2048)
 #define ANIMATION_DURATION (.2f)
 #define HOVER_DURATION (.1f)
+#define SCROLL_ROWS_PER_WHEEL_STEP (3.f)
+#define TEXT_CACHE_WAYS (4)
+#define TEXT_CACHE_SETS (32)
+#define FORMAT_MAX_PRECISION (9)
+#ifndef MAX_DIRTY_SEGMENTS
+#define MAX_DIRTY_SEGMENTS (512)
+#endif
+#define MAX_DIRTY_RECTS (16)
+#define LINEAR_LUT_SIZE (4096)
+#define PALETTE_STEPS (64)
+#define KNOB_SWEEP_STEPS (256)
+#define QUANTIZE_CHUNK (256)
+#define TABLE_MERGE_CHUNK (256)
+#define LOG_MAX_COLUMNS (512)
+#define LOG_INDEX_BUDGET ((size_t)16 << 20)
+#define KNOB_MIN_ANGLE (-4.1887902f)
+#define KNOB_MAX_ANGLE (1.0471975512f)
+
+// frame statistics, define UI_STATS to 0 to compile them out
+#ifndef UI_STATS
+#define UI_STATS (1)
+#endif
+
+#if UI_STATS
+#define UI_STAT(statement) statement
+#else
+#define UI_STAT(statement)
+#endif
+
+// Renderer dispatch : the renderer is called through the callbacks of ui_def unless UI_RENDERER_DRAW_BOX,
+// UI_RENDERER_DRAW_TEXT, UI_RENDERER_DRAW_LINE, UI_RENDERER_SET_CLIP_RECT or UI_RENDERER_TEXT_WIDTH is defined to the
+// name of a function with the signature of the callback. These functions are bound at compile time and can be inlined
+// in the widgets when lean_ui.c is compiled in the same file (see LEAN_UI_IMPLEMENTATION), the callback can then be
+// NULL in ui_def. The user pointer is still renderer_callbacks.user.
+#ifdef UI_RENDERER_DRAW_BOX
+void UI_RENDERER_DRAW_BOX(float x, float y, float width, float height, float radius, uint32_t srgb_color, void* user);
+#define RENDERER_DRAW_BOX(ctx, x, y, width, height, radius, color) UI_RENDERER_DRAW_BOX(x, y, width, height, radius, color, (ctx)->renderer.user)
+#else
+#define RENDERER_DRAW_BOX(ctx, x, y, width, height, radius, color) (ctx)->renderer.draw_box(x, y, width, height, radius, color, (ctx)->renderer.user)
+#endif
+
+#ifdef UI_RENDERER_DRAW_TEXT
+void UI_RENDERER_DRAW_TEXT(float x, float y, const char* text, uint32_t srgb_color, void* user);
+#define RENDERER_DRAW_TEXT(ctx, x, y, text, color) UI_RENDERER_DRAW_TEXT(x, y, text, color, (ctx)->renderer.user)
+#else
+#define RENDERER_DRAW_TEXT(ctx, x, y, text, color) (ctx)->renderer.draw_text(x, y, text, color, (ctx)->renderer.user)
+#endif
+
+#ifdef UI_RENDERER_DRAW_LINE
+void UI_RENDERER_DRAW_LINE(float x0, float y0, float x1, float y1, float width, uint32_t srgb_color, void* user);
+#define RENDERER_DRAW_LINE(ctx, x0, y0, x1, y1, width, color) UI_RENDERER_DRAW_LINE(x0, y0, x1, y1, width, color, (ctx)->renderer.user)
+#else
+#define RENDERER_DRAW_LINE(ctx, x0, y0, x1, y1, width, color) (ctx)->renderer.draw_line(x0, y0, x1, y1, width, color, (ctx)->renderer.user)
+#endif
+
+#ifdef UI_RENDERER_SET_CLIP_RECT
+void UI_RENDERER_SET_CLIP_RECT(uint16_t min_x, uint16_t min_y, uint16_t max_x, uint16_t max_y, void* user);
+#define RENDERER_SET_CLIP_RECT(ctx, min_x, min_y, max_x, max_y) UI_RENDERER_SET_CLIP_RECT(min_x, min_y, max_x, max_y, (ctx)->renderer.user)
+#else
+#define RENDERER_SET_CLIP_RECT(ctx, min_x, min_y, max_x, max_y) (ctx)->renderer.set_clip_rect(min_x, min_y, max_x, max_y, (ctx)->renderer.user)
+#endif
+
+#ifdef UI_RENDERER_TEXT_WIDTH
+float UI_RENDERER_TEXT_WIDTH(const char* text, void* user);
+#define RENDERER_TEXT_WIDTH(ctx, text) UI_RENDERER_TEXT_WIDTH(text, (ctx)->renderer.user)
+#define HAS_TEXT_WIDTH(def) (true)
+#else
+#define RENDERER_TEXT_WIDTH(ctx, text) (ctx)->renderer.text_width(text, (ctx)->renderer.user)
+#define HAS_TEXT_WIDTH(def) ((def)->renderer_callbacks.text_width != NULL)
+#endif
+
+// the callbacks needed in immediate mode
+#if defined(UI_RENDERER_DRAW_BOX) && defined(UI_RENDERER_DRAW_TEXT) && defined(UI_RENDERER_DRAW_LINE) && defined(UI_RENDERER_SET_CLIP_RECT)
+#define HAS_DRAW_CALLBACKS(def) (true)
+#else
+#define HAS_DRAW_CALLBACKS(def) ((def)->renderer_callbacks.draw_box && (def)->renderer_callbacks.draw_text && \
+                                 (def)->renderer_callbacks.set_clip_rect && (def)->renderer_callbacks.draw_line)
+#endif
 
 //-----------------------------------------------------------------------------------------------------------------------------
 // Structures
@@ -24,9 +117,31 @@ typedef struct
     float width, height;
     float min_width, min_height;
     uint32_t options;
+    float scroll;
+    float content_height;
+    uint32_t last_frame;        // frame of the last ui_begin_window()
+    uint32_t command_offset;    // deferred mode, commands of the window during last_frame
+    uint32_t command_count;
+    uint32_t z;                 // stacking order, the window with the highest z is on top
     bool closed;
 } ui_window;
 
+typedef struct
+{
+    ui_vec2 pos;
+    enum ui_button_state button;
+    bool down;
+    bool doubleclick;
+    float wheel;
+} ui_mouse_state;
+
+typedef struct
+{
+    uint32_t offset, count;
+    uint32_t z;
+    ui_window* window;          // NULL for commands outside of a window
+} ui_command_range;
+
 typedef struct
 {
     uint32_t window_border;
@@ -43,20 +158,61 @@ typedef struct
     uint32_t separator;
 } ui_colors;
 
+enum ui_animation_kind
+{
+    animation_tween,
+    animation_hover
+};
+
+// animations are keyed by widget pointer and kind, stored as structure of arrays so all the timers are advanced
+// in one loop. Entries not looked up during a frame and finished tweens are evicted at the end of the frame.
+typedef struct
+{
+    const void* widget[MAX_ANIMATIONS];
+    uint8_t kind[MAX_ANIMATIONS];
+    bool key0_to_key1[MAX_ANIMATIONS];
+    uint32_t last_frame[MAX_ANIMATIONS];
+    float t[MAX_ANIMATIONS];
+    float speed[MAX_ANIMATIONS];            // 1 / duration
+    float value_key0[MAX_ANIMATIONS];
+    float value_key1[MAX_ANIMATIONS];
+    uint32_t color_key0[MAX_ANIMATIONS];
+    uint32_t color_key1[MAX_ANIMATIONS];
+    uint32_t count;
+} ui_animation_pool;
+
+typedef struct
+{
+    const char* text;
+    uint32_t hash;
+    uint32_t last_frame;
+    float width;
+} ui_text_entry;
+
+// transitions between two fixed colors of the theme, precomputed at init
+enum ui_palette_pair
+{
+    palette_hover,              // widget_bg to widget_hover
+    palette_press,              // accent to window_bg
+    palette_toggle,             // accent to separator
+    palette_heatmap,            // widget_bg to accent
+    palette_count
+};
+
 typedef struct
 {
-    float value_key0, value_key1;
-    uint32_t color_key0, color_key1;
-    bool key0_to_key1;
-    float t;
-    void* widget;
-} ui_animation;
+    uint32_t from, to;
+    uint32_t colors[PALETTE_STEPS + 1];
+} ui_palette;
 
-typedef struct 
+// primitives of the window chrome or of a widget, compared with the segment at the same position in the last frame
+typedef struct
 {
-    void* widget;
-    float t;
-} ui_hover;
+    uint32_t window_id;         // 0 outside of the windows
+    uint32_t index;             // 0 for the window chrome, then one per widget
+    uint32_t hash;              // of the primitives
+    float min_x, min_y, max_x, max_y;
+} ui_dirty_segment;
 
 
 struct ui_context
@@ -66,21 +222,67 @@ struct ui_context
     bool mouse_down;
     bool mouse_doubleclick;
     float doubleclick_timer;
+    float mouse_wheel;
     ui_window windows[MAX_WINDOWS];
     uint32_t num_windows;
+    uint16_t window_table[WINDOW_TABLE_SIZE];   // open addressing, index+1 of the window, 0 if empty
     ui_window* current_window;
+    ui_window* input_window;    // topmost window under the mouse, or the window clicked while the button is down
+    ui_window* pressed_window;
+    uint32_t z_counter;
+    bool shared_input;          // set by ui_copy_input() when the windows are merged, the input window is found by id
+    bool has_shared_input_window;
+    uint32_t shared_input_id;
+    ui_mouse_state hidden_mouse;
+    bool mouse_hidden;
+    bool occluded;              // the current window is covered, nothing is drawn
+    ui_vec2 last_mouse_pos;
+    bool input_received;        // the mouse moved or a button/wheel event happened since the last frame
+    bool idle;
     ui_window* resizing_window;
-    void* dragging_object;
-    ui_animation animation;
-    ui_hover hover;
+    const void* dragging_object;
+    const void* widget_key;     // see ui_set_widget_key()
+    ui_animation_pool animations;
     ui_vec2 dragging_offset;
+    float dragging_value;       // value of the dragged knob, keeps the fraction lost by a caller storing an integer
     ui_rect layout;
+    ui_rect clip;
+    float content_y;
+    uint32_t culled_widgets;
+    uint32_t list_num_items;
+    uint32_t list_next;
+    uint32_t list_end;
+    float list_item_height;
+    float list_y;
     float font_height;
     float row_height;
     float padding;
     float corner;
     ui_colors colors;
+    ui_palette palettes[palette_count];
+    float srgb_to_linear[256];
+    uint8_t linear_to_srgb[LINEAR_LUT_SIZE];
+    ui_vec2 knob_sweep[KNOB_SWEEP_STEPS + 1];
     ui_renderer_fnc_t renderer;
+    uint8_t* command_buffer;
+    size_t command_buffer_size;
+    size_t command_text_offset;
+    uint32_t num_commands;
+    uint32_t frame_index;
+    uint32_t text_cache_hits;
+    uint32_t text_cache_misses;
+    double (*get_time)(void);
+    double window_start_time;
+    ui_frame_stats stats;
+    ui_window_stats window_stats[MAX_WINDOWS];
+    bool track_dirty_rects;
+    uint32_t dirty_frame;       // 0 or 1, segments of the current frame
+    uint32_t dirty_index;
+    uint32_t num_dirty_segments[2];
+    uint32_t num_dirty_rects;
+    ui_dirty_segment dirty_segments[2][MAX_DIRTY_SEGMENTS];
+    ui_rect dirty_rects[MAX_DIRTY_RECTS];
+    ui_text_entry text_cache[TEXT_CACHE_SETS][TEXT_CACHE_WAYS];
     char string_buffer[STRING_BUFFER_SIZE];
 };
 
@@ -123,658 +325,2910 @@ static inline uint32_t ui_hash(const void *data, size_t length)
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-static inline uint32_t lerp_color(uint32_t a, uint32_t b, float t)
-{
-    int tt = (int)(t * 256.f);
-    int oneminust = 256 - tt;
+// Colors are blended in linear space : sRGB channels are decoded with a table, the result is encoded with a table
+// indexed by the linear value on 12 bits. Alpha is linear. The four channels are interpolated at once.
+//-----------------------------------------------------------------------------------------------------------------------------
 
-    uint32_t A = (((a >> 24) & 0xFF) * oneminust + ((b >> 24) & 0xFF) * tt) >> 8;
-    uint32_t B = (((a >> 16) & 0xFF) * oneminust + ((b >> 16) & 0xFF) * tt) >> 8;
-    uint32_t G = (((a >> 8)  & 0xFF) * oneminust + ((b >> 8)  & 0xFF) * tt) >> 8;
-    uint32_t R = (((a >> 0)  & 0xFF) * oneminust + ((b >> 0)  & 0xFF) * tt) >> 8;
+//-----------------------------------------------------------------------------------------------------------------------------
+static void init_color_tables(ui_context* ctx)
+{
+    for(uint32_t i=0; i<256; ++i)
+    {
+        float c = (float) i / 255.f;
+        ctx->srgb_to_linear[i] = (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+    }
 
-    return (A << 24) | (B << 16) | (G << 8) | R;
+    for(uint32_t i=0; i<LINEAR_LUT_SIZE; ++i)
+    {
+        float l = (float) i / (float) (LINEAR_LUT_SIZE - 1);
+        float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * powf(l, 1.f / 2.4f) - 0.055f;
+        ctx->linear_to_srgb[i] = (uint8_t) (c * 255.f + .5f);
+    }
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-static inline void draw_align_text(ui_context* ctx, const ui_rect* rect, const char* text, uint32_t srgb_color, enum ui_text_alignment alignment)
+// [t] in [0, 1]
+static inline uint32_t lerp_color_linear(const ui_context* ctx, uint32_t a, uint32_t b, float t)
 {
-    if (alignment == align_left)
-        ctx->renderer.draw_text(rect->x, rect->y, text, srgb_color, ctx->renderer.user);
-    else
+    const float* lut = ctx->srgb_to_linear;
+    int32_t index[4];
+
+#if defined(SIMD_SSE2)
+    __m128 ca = _mm_setr_ps(lut[a & 0xFF], lut[(a >> 8) & 0xFF], lut[(a >> 16) & 0xFF], (float) (a >> 24) * (1.f / 255.f));
+    __m128 cb = _mm_setr_ps(lut[b & 0xFF], lut[(b >> 8) & 0xFF], lut[(b >> 16) & 0xFF], (float) (b >> 24) * (1.f / 255.f));
+    __m128 c = _mm_add_ps(ca, _mm_mul_ps(_mm_sub_ps(cb, ca), _mm_set1_ps(t)));
+    __m128 scale = _mm_setr_ps(LINEAR_LUT_SIZE - 1, LINEAR_LUT_SIZE - 1, LINEAR_LUT_SIZE - 1, 255.f);
+    _mm_storeu_si128((__m128i*) index, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(c, scale), _mm_set1_ps(.5f))));
+#elif defined(SIMD_NEON)
+    const float la[4] = {lut[a & 0xFF], lut[(a >> 8) & 0xFF], lut[(a >> 16) & 0xFF], (float) (a >> 24) * (1.f / 255.f)};
+    const float lb[4] = {lut[b & 0xFF], lut[(b >> 8) & 0xFF], lut[(b >> 16) & 0xFF], (float) (b >> 24) * (1.f / 255.f)};
+    const float scale[4] = {LINEAR_LUT_SIZE - 1, LINEAR_LUT_SIZE - 1, LINEAR_LUT_SIZE - 1, 255.f};
+    float32x4_t ca = vld1q_f32(la), cb = vld1q_f32(lb);
+    float32x4_t c = vmlaq_f32(ca, vsubq_f32(cb, ca), vdupq_n_f32(t));
+    vst1q_s32(index, vcvtq_s32_f32(vmlaq_f32(vdupq_n_f32(.5f), c, vld1q_f32(scale))));
+#else
+    for(uint32_t i=0; i<4; ++i)
     {
-        float text_width = ctx->renderer.text_width(text, ctx->renderer.user);
-        if (alignment == align_right)
-            ctx->renderer.draw_text(rect->x + rect->width - text_width, rect->y, text, srgb_color, ctx->renderer.user);
-        else
-            ctx->renderer.draw_text(rect->x + rect->width*.5f - text_width*.5f, rect->y, text, srgb_color, ctx->renderer.user);
+        uint32_t shift = i * 8;
+        float ca = (i < 3) ? lut[(a >> shift) & 0xFF] : (float) (a >> 24) * (1.f / 255.f);
+        float cb = (i < 3) ? lut[(b >> shift) & 0xFF] : (float) (b >> 24) * (1.f / 255.f);
+        float scale = (i < 3) ? (float) (LINEAR_LUT_SIZE - 1) : 255.f;
+        index[i] = (int32_t) (lerp_float(ca, cb, t) * scale + .5f);
     }
+#endif
+
+    return (uint32_t) ctx->linear_to_srgb[index[0]] | ((uint32_t) ctx->linear_to_srgb[index[1]] << 8) |
+           ((uint32_t) ctx->linear_to_srgb[index[2]] << 16) | ((uint32_t) index[3] << 24);
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-static inline void draw_disc(ui_context* ctx, float x, float y, float radius, uint32_t srgb_color)
+static void init_palettes(ui_context* ctx)
 {
-    ctx->renderer.draw_box(x - radius, y - radius, radius*2.f, radius*2.f, radius, srgb_color, ctx->renderer.user);
-}
+    const uint32_t pairs[palette_count][2] =
+    {
+        [palette_hover] = {ctx->colors.widget_bg, ctx->colors.widget_hover},
+        [palette_press] = {ctx->colors.accent, ctx->colors.window_bg},
+        [palette_toggle] = {ctx->colors.accent, ctx->colors.separator},
+        [palette_heatmap] = {ctx->colors.widget_bg, ctx->colors.accent}
+    };
 
-//-----------------------------------------------------------------------------------------------------------------------------
-// UI functions
-//-----------------------------------------------------------------------------------------------------------------------------
+    for(uint32_t i=0; i<palette_count; ++i)
+    {
+        ui_palette* palette = &ctx->palettes[i];
+        palette->from = pairs[i][0];
+        palette->to = pairs[i][1];
+        for(uint32_t step=0; step<=PALETTE_STEPS; ++step)
+            palette->colors[step] = lerp_color_linear(ctx, palette->from, palette->to, (float) step / (float) PALETTE_STEPS);
+    }
+}
 
 //-----------------------------------------------------------------------------------------------------------------------------
-size_t ui_min_memory_size(void)
+// the transitions between colors of the theme are read from the palettes, t is then rounded to 1/PALETTE_STEPS
+static inline uint32_t lerp_color(const ui_context* ctx, uint32_t a, uint32_t b, float t)
 {
-    return sizeof(ui_context);
+    t = clamp_float(0.f, 1.f, t);
+    for(uint32_t i=0; i<palette_count; ++i)
+        if (ctx->palettes[i].from == a && ctx->palettes[i].to == b)
+            return ctx->palettes[i].colors[(uint32_t) (t * PALETTE_STEPS + .5f)];
+
+    return lerp_color_linear(ctx, a, b, t);
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-ui_context* ui_init(const ui_def* def)
+// Text width cache, entries are identified by the pointer and the hash of the content (string_buffer is reused)
+// When a set is full, the entry used the longest time ago is replaced
+static inline float measure_text(ui_context* ctx, const char* text)
 {
-    assert(def->renderer_callbacks.draw_box && def->renderer_callbacks.draw_text &&
-           def->renderer_callbacks.set_clip_rect && def->renderer_callbacks.text_width &&
-           def->renderer_callbacks.draw_line);
-    
-    assert(((uintptr_t)def->preallocated_buffer)%sizeof(uintptr_t) == 0);
+    uint32_t hash = ui_hash(text, strlen(text));
+    uintptr_t address = (uintptr_t) text;
+    uint32_t set_index = (hash ^ (uint32_t)(address >> 3) ^ (uint32_t)(address >> 11)) & (TEXT_CACHE_SETS - 1);
+    ui_text_entry* set = ctx->text_cache[set_index];
+    ui_text_entry* oldest = &set[0];
 
-    ui_context* ctx = (ui_context*)def->preallocated_buffer;
-    *ctx = (ui_context)
+    for(uint32_t i=0; i<TEXT_CACHE_WAYS; ++i)
     {
-        .mouse_button = button_idle,
-        .font_height = def->font_height,
-        .renderer = def->renderer_callbacks,
-        .padding = fmaxf(def->font_height/4.f, 2.f),
-        .corner = fmaxf(def->font_height/2.f, 2.f),
-        .colors = 
+        ui_text_entry* entry = &set[i];
+        if (entry->text == text && entry->hash == hash)
         {
-            .window_bg = 0xFFF7F0E9,
-            .window_border = 0xFFE3CDB8,
-            .title_bg = 0xFFE5C4A8,
-            .title_text = 0xFF402A1B,
-            .widget_bg = 0xFFF4E6D8,
-            .widget_hover = 0xFFEEDBC3,
-            .widget_active = 0xFFE7CCB0,
-            .text = 0xFF553E2C,
-            .accent = 0xFFE68B3E,
-            .value_bg = 0xFFEDE6DE,
-            .value_text = 0xFF1E1E1E,
-            .separator = 0x40553E2C
+            entry->last_frame = ctx->frame_index;
+            ctx->text_cache_hits++;
+            return entry->width;
         }
+
+        if (entry->text == NULL || (oldest->text != NULL && entry->last_frame < oldest->last_frame))
+            oldest = entry;
+    }
+
+    ctx->text_cache_misses++;
+    UI_STAT(ctx->stats.text_width++);
+    *oldest = (ui_text_entry)
+    {
+        .text = text,
+        .hash = hash,
+        .last_frame = ctx->frame_index,
+        .width = RENDERER_TEXT_WIDTH(ctx, text)
     };
-    ctx->row_height = ctx->font_height * 1.5f;
-    return ctx;
+    return oldest->width;
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-void ui_update_mouse_pos(ui_context* ctx, float x, float y)
+// Deferred mode : commands are stored from the beginning of the buffer, text from the end
+static inline ui_command* push_command(ui_context* ctx, enum ui_command_type type, uint32_t srgb_color)
 {
-    ctx->mouse_pos = (ui_vec2) {x, y};
+    size_t offset = ctx->num_commands * sizeof(ui_command);
+    if (offset + sizeof(ui_command) > ctx->command_text_offset)
+    {
+        assert(!"command buffer is too small");
+        return NULL;
+    }
+
+    ui_command* cmd = (ui_command*) (ctx->command_buffer + offset);
+    cmd->type = type;
+    cmd->srgb_color = srgb_color;
+    ctx->num_commands++;
+    return cmd;
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-void ui_update_mouse_button(ui_context* ctx, enum ui_button_state button)
+// Dirty rects : the primitives are hashed in segments, one for the chrome of each window and one per widget
+//-----------------------------------------------------------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// when there are too many segments, the last one takes the remaining primitives
+static inline void dirty_begin_segment(ui_context* ctx, uint32_t window_id, uint32_t index)
 {
-    ctx->mouse_button = button;
+    if (!ctx->track_dirty_rects)
+        return;
 
-    if (button == button_pressed)
-    {
-        ctx->mouse_down = true;
-        ctx->mouse_doubleclick = (ctx->doubleclick_timer < 0.25f);
-        ctx->doubleclick_timer = 0.f;
-    }
-    else
-    {
-        ctx->mouse_down = false;
-        ctx->mouse_doubleclick = false;
-    }
+    uint32_t* count = &ctx->num_dirty_segments[ctx->dirty_frame];
+    if (*count < MAX_DIRTY_SEGMENTS)
+        ctx->dirty_segments[ctx->dirty_frame][(*count)++] = (ui_dirty_segment)
+        {
+            .window_id = window_id,
+            .index = index,
+            .hash = 0x811c9dc5,
+            .min_x = FLT_MAX, .min_y = FLT_MAX, .max_x = -FLT_MAX, .max_y = -FLT_MAX
+        };
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-void ui_begin_frame(ui_context* ctx, float delta_time)
+// adds a primitive to the current segment, the bounds are clipped by the clip rect of the window
+static inline void dirty_primitive(ui_context* ctx, const void* data, size_t size, float x0, float y0, float x1, float y1)
 {
-    ctx->current_window = NULL;
-    ctx->animation.t = fminf(1.f, ctx->animation.t + delta_time/ANIMATION_DURATION);
-    ctx->hover.t = fminf(1.f, ctx->hover.t + delta_time/HOVER_DURATION);
-    ctx->doubleclick_timer += delta_time;
+    ui_dirty_segment* segment = &ctx->dirty_segments[ctx->dirty_frame][ctx->num_dirty_segments[ctx->dirty_frame] - 1];
+    const uint8_t* p = (const uint8_t*) data;
+    for(size_t i=0; i<size; ++i)
+        segment->hash = (segment->hash ^ p[i]) * 0x01000193;
+
+    x0 = fmaxf(x0, ctx->clip.x); y0 = fmaxf(y0, ctx->clip.y);
+    x1 = fminf(x1, ctx->clip.x + ctx->clip.width); y1 = fminf(y1, ctx->clip.y + ctx->clip.height);
+    if (x0 < x1 && y0 < y1)
+    {
+        segment->min_x = fminf(segment->min_x, x0); segment->min_y = fminf(segment->min_y, y0);
+        segment->max_x = fmaxf(segment->max_x, x1); segment->max_y = fmaxf(segment->max_y, y1);
+    }
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-void ui_begin_window(ui_context* ctx, const char* name, float x, float y, float width, float height, uint32_t options)
+// merges the rect with the dirty rects it overlaps, when the array is full the rect growing the least is used
+static void add_dirty_rect(ui_context* ctx, const ui_dirty_segment* segment)
 {
-    assert(ctx->current_window == NULL);
+    if (segment->min_x >= segment->max_x || segment->min_y >= segment->max_y)
+        return;
 
-    uint32_t id = ui_hash(name, strlen(name));
+    float min_x = segment->min_x, min_y = segment->min_y, max_x = segment->max_x, max_y = segment->max_y;
+    for(uint32_t i=0; i<ctx->num_dirty_rects; )
+    {
+        ui_rect* r = &ctx->dirty_rects[i];
+        if (r->x > max_x || r->y > max_y || r->x + r->width < min_x || r->y + r->height < min_y)
+        {
+            ++i;
+            continue;
+        }
 
-    // already created?
-    for(uint32_t i=0; i<ctx->num_windows; ++i)
-        if (ctx->windows[i].id == id)
-            ctx->current_window = &ctx->windows[i];
+        // overlap : the union is added instead, it can overlap other rects
+        min_x = fminf(min_x, r->x); min_y = fminf(min_y, r->y);
+        max_x = fmaxf(max_x, r->x + r->width); max_y = fmaxf(max_y, r->y + r->height);
+        *r = ctx->dirty_rects[--ctx->num_dirty_rects];
+        i = 0;
+    }
 
-    // not found, create one
-    if (ctx->current_window == NULL)
+    if (ctx->num_dirty_rects == MAX_DIRTY_RECTS)
     {
-        assert(ctx->num_windows < MAX_WINDOWS);
-        ctx->current_window = &ctx->windows[ctx->num_windows++];
-        *ctx->current_window = (ui_window)
+        uint32_t best = 0;
+        float best_growth = FLT_MAX;
+        for(uint32_t i=0; i<MAX_DIRTY_RECTS; ++i)
         {
-            .name = name,
-            .id = id,
-            .pos = {.x = x, .y = y},
-            .min_width = ctx->renderer.text_width(name, ctx->renderer.user) + ctx->padding * 2.f,
-            .min_height = ctx->row_height * 2.f,
-            .width = width,
-            .height = height,
-            .options = options,
-            .closed = false
-        };
+            const ui_rect* r = &ctx->dirty_rects[i];
+            float width = fmaxf(max_x, r->x + r->width) - fminf(min_x, r->x);
+            float height = fmaxf(max_y, r->y + r->height) - fminf(min_y, r->y);
+            float growth = width * height - r->width * r->height;
+            if (growth < best_growth)
+            {
+                best_growth = growth;
+                best = i;
+            }
+        }
+
+        ui_rect* r = &ctx->dirty_rects[best];
+        min_x = fminf(min_x, r->x); min_y = fminf(min_y, r->y);
+        max_x = fmaxf(max_x, r->x + r->width); max_y = fmaxf(max_y, r->y + r->height);
+        *r = (ui_rect) {min_x, min_y, max_x - min_x, max_y - min_y};
+        return;
     }
 
-    ui_window* w = ctx->current_window;
+    ctx->dirty_rects[ctx->num_dirty_rects++] = (ui_rect) {min_x, min_y, max_x - min_x, max_y - min_y};
+}
 
-    // resize
-    ui_rect handle_rect = {w->pos.x + w->width - ctx->corner, w->pos.y + w->height - ctx->corner, ctx->corner, ctx->corner};
-    if (ctx->mouse_button == button_pressed && in_rect(&handle_rect, ctx->mouse_pos) && (w->options&window_resizable))
-    {
-        ctx->resizing_window = w;
-        ctx->dragging_offset = ui_vec2_sub(ui_vec2_add(w->pos, (ui_vec2) {w->width, w->height}), ctx->mouse_pos);
-    }
+//-----------------------------------------------------------------------------------------------------------------------------
+// compares the segments of the frame with the ones of the last frame, in building order
+static void compute_dirty_rects(ui_context* ctx)
+{
+    const ui_dirty_segment* current = ctx->dirty_segments[ctx->dirty_frame];
+    const ui_dirty_segment* previous = ctx->dirty_segments[ctx->dirty_frame ^ 1];
+    uint32_t num_current = ctx->num_dirty_segments[ctx->dirty_frame];
+    uint32_t num_previous = ctx->num_dirty_segments[ctx->dirty_frame ^ 1];
 
-    if (ctx->mouse_down && ctx->resizing_window == w)
+    ctx->num_dirty_rects = 0;
+    for(uint32_t i=0; i<num_current || i<num_previous; ++i)
     {
-        w->width = fmaxf(ctx->mouse_pos.x + ctx->dragging_offset.x - w->pos.x, w->min_width);
-        w->height = fmaxf(ctx->mouse_pos.y + ctx->dragging_offset.y - w->pos.y, w->min_height);
+        if (i < num_current && i < num_previous && current[i].window_id == previous[i].window_id &&
+            current[i].index == previous[i].index && current[i].hash == previous[i].hash)
+            continue;
+
+        if (i < num_current)
+            add_dirty_rect(ctx, &current[i]);
+        if (i < num_previous)
+            add_dirty_rect(ctx, &previous[i]);
     }
+}
 
-    ui_rect title_rect = {w->pos.x+ctx->padding, w->pos.y+ctx->padding, w->width-ctx->padding*2.f, ctx->row_height};
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline void render_box(ui_context* ctx, float x, float y, float width, float height, float radius, uint32_t srgb_color)
+{
+    if (ctx->occluded)
+        return;
 
-    // move the window if click on the title bar
-    if (ctx->mouse_button == button_pressed && in_rect(&title_rect, ctx->mouse_pos) &&
-        !(w->options&window_pinned) && ctx->resizing_window != w)
+    UI_STAT(ctx->stats.draw_box++);
+    if (ctx->track_dirty_rects)
     {
-        ctx->dragging_object = w;
-        ctx->dragging_offset = ui_vec2_sub(ctx->mouse_pos, w->pos);
+        float data[5] = {x, y, width, height, radius};
+        dirty_primitive(ctx, data, sizeof(data), x, y, x + width, y + height);
+        dirty_primitive(ctx, &srgb_color, sizeof(srgb_color), x, y, x, y);
     }
 
-    if (ctx->mouse_down && ctx->dragging_object == w)
-        w->pos = ui_vec2_sub(ctx->mouse_pos, ctx->dragging_offset);
-
-    // border
-    ctx->renderer.draw_box(w->pos.x, w->pos.y, w->width, w->height, ctx->corner, ctx->colors.window_border, ctx->renderer.user);
-
-    // title bg
-    ctx->renderer.draw_box(title_rect.x, title_rect.y, title_rect.width, title_rect.height, ctx->corner, ctx->colors.title_bg, ctx->renderer.user);
-
-    ctx->layout = (ui_rect)
+    if (ctx->command_buffer == NULL)
+        RENDERER_DRAW_BOX(ctx, x, y, width, height, radius, srgb_color);
+    else
     {
-        .x = w->pos.x + ctx->padding,
-        .y = title_rect.y + title_rect.height + ctx->padding,
-        .width = w->width - ctx->padding*2.f,
-        .height = ctx->row_height
-    };
-
-    // background
-    ctx->renderer.draw_box(ctx->layout.x, ctx->layout.y, ctx->layout.width, 
-                           w->height - title_rect.height - ctx->padding*3.f, 0, ctx->colors.window_bg, ctx->renderer.user);
-    
-    ctx->layout.x += ctx->padding;
-    ctx->layout.width -= 2.f * ctx->padding;
-
-    // title
-    draw_align_text(ctx, &title_rect, w->name, ctx->colors.title_text, align_center);
-
-    // draw resize handle
-    if (w->options&window_resizable)
-        ctx->renderer.draw_box(handle_rect.x, handle_rect.y, handle_rect.width, handle_rect.height, 0.f, ctx->colors.separator, ctx->renderer.user);
-
-    // clip rect
-    uint16_t clip_minx = (uint16_t) fmaxf(ctx->layout.x, 0.f);
-    uint16_t clip_miny = (uint16_t) fmaxf(ctx->layout.y, 0.f);
-    uint16_t clip_maxx = (uint16_t) (ctx->layout.x + ctx->layout.width + .5f);
-    uint16_t clip_maxy = (uint16_t) (w->pos.y + w->height - ctx->padding + .5f);
-    ctx->renderer.set_clip_rect(clip_minx, clip_miny, clip_maxx, clip_maxy, ctx->renderer.user);
+        ui_command* cmd = push_command(ctx, command_box, srgb_color);
+        if (cmd != NULL)
+        {
+            cmd->data.box.x = x; cmd->data.box.y = y;
+            cmd->data.box.width = width; cmd->data.box.height = height;
+            cmd->data.box.radius = radius;
+        }
+    }
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-void ui_text(ui_context* ctx, enum ui_text_alignment alignment, const char* string, ...)
+// the text could be in string_buffer, copy it in the command buffer
+static inline void push_text(ui_context* ctx, float x, float y, const char* text, size_t length, uint32_t srgb_color)
 {
-    assert(ctx->current_window != NULL);
+    size_t commands_end = (ctx->num_commands + 1) * sizeof(ui_command);
+    if (commands_end + length + 1 > ctx->command_text_offset)
+    {
+        assert(!"command buffer is too small");
+        return;
+    }
 
-    va_list args;
-    va_start(args, string);
-    vsnprintf(ctx->string_buffer, STRING_BUFFER_SIZE, string, args);
-    va_end(args);
+    ctx->command_text_offset -= length + 1;
+    char* copy = (char*) (ctx->command_buffer + ctx->command_text_offset);
+    memcpy(copy, text, length);
+    copy[length] = 0;
 
-    draw_align_text(ctx, &ctx->layout, ctx->string_buffer, ctx->colors.text, alignment);
+    ui_command* cmd = push_command(ctx, command_text, srgb_color);
+    cmd->data.text.x = x; cmd->data.text.y = y;
+    cmd->data.text.text = copy;
+    cmd->data.text.length = (uint32_t) length;
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-void ui_newline(ui_context* ctx)
+static inline void dirty_text(ui_context* ctx, float x, float y, const char* text, size_t length, uint32_t srgb_color)
 {
-    assert(ctx->current_window != NULL);
-    ctx->layout.x = ctx->current_window->pos.x + ctx->padding * 2.f;
-    ctx->layout.y += ctx->layout.height;
-    ctx->layout.width = ctx->current_window->width - ctx->padding * 4.f;
-    ctx->layout.height = ctx->row_height;
+    float data[2] = {x, y};
+    dirty_primitive(ctx, data, sizeof(data), x, y, x + measure_text(ctx, text), y + ctx->font_height);
+    dirty_primitive(ctx, &srgb_color, sizeof(srgb_color), x, y, x, y);
+    dirty_primitive(ctx, text, length, x, y, x, y);
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-void ui_separator(ui_context* ctx)
+static inline void render_text(ui_context* ctx, float x, float y, const char* text, uint32_t srgb_color)
 {
-    assert(ctx->current_window != NULL);
+    if (ctx->occluded)
+        return;
 
-    float y = ctx->layout.y + .5f * ctx->layout.height;
-    ctx->renderer.draw_box(ctx->layout.x, y, ctx->layout.width, 1.f, 1.f, ctx->colors.separator, ctx->renderer.user);
-    ui_newline(ctx);
+    UI_STAT(ctx->stats.draw_text++);
+    if (ctx->track_dirty_rects)
+        dirty_text(ctx, x, y, text, strlen(text), srgb_color);
+
+    if (ctx->command_buffer == NULL)
+        RENDERER_DRAW_TEXT(ctx, x, y, text, srgb_color);
+    else
+        push_text(ctx, x, y, text, strlen(text), srgb_color);
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-void ui_value(ui_context* ctx, const char* label, const char* fmt, ...)
+// text without NUL (e.g. a line of a log) : copied in the command buffer or, for the renderer, in the string buffer.
+// The width is not measured, the dirty rect goes to the right of the clip rect.
+static inline void render_text_length(ui_context* ctx, float x, float y, const char* text, size_t length, uint32_t srgb_color)
 {
-    assert(ctx->current_window != NULL);
-
-    va_list args;
-    va_start(args, fmt);
-    vsnprintf(ctx->string_buffer, STRING_BUFFER_SIZE, fmt, args);
-    va_end(args);
-
-    ui_rect value_rect = {ctx->layout.x + ctx->layout.width*.5f, ctx->layout.y, ctx->layout.width*.5f, ctx->layout.height};
+    if (ctx->occluded)
+        return;
 
-    ctx->renderer.draw_text(ctx->layout.x, ctx->layout.y, label, ctx->colors.text, ctx->renderer.user);
-    ctx->renderer.draw_box(value_rect.x, value_rect.y, value_rect.width, value_rect.height, 0, ctx->colors.value_bg, ctx->renderer.user);
-    ctx->renderer.draw_box(value_rect.x-0.5f, value_rect.y+ctx->padding, 1.f, value_rect.height-ctx->padding*2, 0, ctx->colors.separator, ctx->renderer.user);
+    UI_STAT(ctx->stats.draw_text++);
+    if (ctx->track_dirty_rects)
+    {
+        float data[2] = {x, y};
+        dirty_primitive(ctx, data, sizeof(data), x, y, ctx->clip.x + ctx->clip.width, y + ctx->font_height);
+        dirty_primitive(ctx, &srgb_color, sizeof(srgb_color), x, y, x, y);
+        dirty_primitive(ctx, text, length, x, y, x, y);
+    }
 
-    draw_align_text(ctx, &value_rect, ctx->string_buffer, ctx->colors.value_text, align_right);
-    ui_newline(ctx);
+    if (ctx->command_buffer == NULL)
+    {
+        length = (length < STRING_BUFFER_SIZE) ? length : STRING_BUFFER_SIZE - 1;
+        memcpy(ctx->string_buffer, text, length);
+        ctx->string_buffer[length] = 0;
+        RENDERER_DRAW_TEXT(ctx, x, y, ctx->string_buffer, srgb_color);
+    }
+    else
+        push_text(ctx, x, y, text, length, srgb_color);
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-void ui_toggle(ui_context* ctx, const char* label, bool* value)
+static inline void render_line(ui_context* ctx, float x0, float y0, float x1, float y1, float width, uint32_t srgb_color)
 {
-    draw_align_text(ctx, &ctx->layout, label, ctx->colors.text, align_left);
+    if (ctx->occluded)
+        return;
 
-    ui_rect track_rect = 
+    UI_STAT(ctx->stats.draw_line++);
+    if (ctx->track_dirty_rects)
     {
-        .x = ctx->layout.x + ctx->layout.width - ctx->font_height*2.f - ctx->padding,
-        .y = ctx->layout.y+ctx->padding,
-        .width = ctx->font_height*2.f,
-        .height = ctx->font_height
-    };
+        float data[5] = {x0, y0, x1, y1, width};
+        dirty_primitive(ctx, data, sizeof(data), fminf(x0, x1) - width, fminf(y0, y1) - width, fmaxf(x0, x1) + width, fmaxf(y0, y1) + width);
+        dirty_primitive(ctx, &srgb_color, sizeof(srgb_color), x0, y0, x0, y0);
+    }
 
-    if (in_rect(&track_rect, ctx->mouse_pos) && ctx->mouse_button == button_pressed)
+    if (ctx->command_buffer == NULL)
+        RENDERER_DRAW_LINE(ctx, x0, y0, x1, y1, width, srgb_color);
+    else
     {
-        *value = !(*value);
-
-        // setup tweening animation, animate thumb position and track color
-        ctx->animation = (ui_animation)
-        {
-            .value_key0 = track_rect.x + ctx->font_height - 2.f,
-            .value_key1 = track_rect.x + 2.f,
-            .color_key0 = ctx->colors.accent,
-            .color_key1 = ctx->colors.separator,
-            .key0_to_key1 = !(*value),
-            .widget = value
-        };
+        ui_command* cmd = push_command(ctx, command_line, srgb_color);
+        if (cmd != NULL)
+        {
+            cmd->data.line.x0 = x0; cmd->data.line.y0 = y0;
+            cmd->data.line.x1 = x1; cmd->data.line.y1 = y1;
+            cmd->data.line.width = width;
+        }
     }
+}
 
-    ui_rect thumb_rect =
-    {
-        .x = (*value) ? track_rect.x + ctx->font_height - 2.f : track_rect.x + 2.f,
-        .y = track_rect.y + 2.f,
-        .width = ctx->font_height - 4.f,
-        .height = ctx->font_height - 4.f
-    };
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline void render_clip_rect(ui_context* ctx, uint16_t min_x, uint16_t min_y, uint16_t max_x, uint16_t max_y)
+{
+    if (ctx->occluded)
+        return;
 
-    uint32_t track_color;
-    if (ctx->animation.widget == value)
+    UI_STAT(ctx->stats.set_clip_rect++);
+    if (ctx->track_dirty_rects)
     {
-        float t = (ctx->animation.key0_to_key1) ? ctx->animation.t : 1.f - ctx->animation.t;
-        thumb_rect.x = lerp_float(ctx->animation.value_key0, ctx->animation.value_key1, t);
-        track_color = lerp_color(ctx->animation.color_key0, ctx->animation.color_key1, t);
+        uint16_t data[4] = {min_x, min_y, max_x, max_y};
+        dirty_primitive(ctx, data, sizeof(data), 0.f, 0.f, 0.f, 0.f);
     }
+
+    if (ctx->command_buffer == NULL)
+        RENDERER_SET_CLIP_RECT(ctx, min_x, min_y, max_x, max_y);
     else
-        track_color = (*value) ? ctx->colors.accent : ctx->colors.separator;
+    {
+        ui_command* cmd = push_command(ctx, command_clip_rect, 0);
+        if (cmd != NULL)
+        {
+            cmd->data.clip_rect.min_x = min_x; cmd->data.clip_rect.min_y = min_y;
+            cmd->data.clip_rect.max_x = max_x; cmd->data.clip_rect.max_y = max_y;
+        }
+    }
+}
 
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline void draw_align_text(ui_context* ctx, const ui_rect* rect, const char* text, uint32_t srgb_color, enum ui_text_alignment alignment)
+{
+    if (alignment == align_left)
+        render_text(ctx, rect->x, rect->y, text, srgb_color);
+    else
+    {
+        float text_width = measure_text(ctx, text);
+        if (alignment == align_right)
+            render_text(ctx, rect->x + rect->width - text_width, rect->y, text, srgb_color);
+        else
+            render_text(ctx, rect->x + rect->width*.5f - text_width*.5f, rect->y, text, srgb_color);
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the index of the animation of the widget or -1, a found animation is kept alive for the next frame
+static inline int32_t find_animation(ui_context* ctx, const void* widget, enum ui_animation_kind kind)
+{
+    ui_animation_pool* pool = &ctx->animations;
+    for(uint32_t i=0; i<pool->count; ++i)
+    {
+        if (pool->widget[i] == widget && pool->kind[i] == kind)
+        {
+            pool->last_frame[i] = ctx->frame_index;
+            return (int32_t) i;
+        }
+    }
+    return -1;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// (Re)starts the animation of a widget, when the pool is full the most advanced animation is replaced
+static inline uint32_t start_animation(ui_context* ctx, const void* widget, enum ui_animation_kind kind, float duration)
+{
+    ui_animation_pool* pool = &ctx->animations;
+    int32_t found = find_animation(ctx, widget, kind);
+    uint32_t index;
+
+    if (found >= 0)
+        index = (uint32_t) found;
+    else if (pool->count < MAX_ANIMATIONS)
+        index = pool->count++;
+    else
+    {
+        index = 0;
+        for(uint32_t i=1; i<pool->count; ++i)
+            if (pool->t[i] > pool->t[index])
+                index = i;
+    }
+
+    pool->widget[index] = widget;
+    pool->kind[index] = (uint8_t) kind;
+    pool->key0_to_key1[index] = false;
+    pool->last_frame[index] = ctx->frame_index;
+    pool->t[index] = 0.f;
+    pool->speed[index] = 1.f / duration;
+    pool->value_key0[index] = pool->value_key1[index] = 0.f;
+    pool->color_key0[index] = pool->color_key1[index] = 0;
+    return index;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline uint32_t start_tween(ui_context* ctx, const void* widget, float value_key0, float value_key1)
+{
+    uint32_t index = start_animation(ctx, widget, animation_tween, ANIMATION_DURATION);
+    ctx->animations.value_key0[index] = value_key0;
+    ctx->animations.value_key1[index] = value_key1;
+    return index;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the identity of the widget for the animations and the dragging : the pointer to its value unless a key
+// was given by ui_set_widget_key(). Called before the culling, the key applies to one widget only.
+static inline const void* widget_key(ui_context* ctx, const void* value)
+{
+    const void* key = (ctx->widget_key != NULL) ? ctx->widget_key : value;
+    ctx->widget_key = NULL;
+    return key;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// adds widgets to the stats of the frame and of the current window
+static inline void count_widgets(ui_context* ctx, uint32_t count, bool culled)
+{
+    UI_STAT(ctx->stats.widgets += count);
+    UI_STAT(if (ctx->stats.num_windows > 0) ctx->window_stats[ctx->stats.num_windows - 1].widgets += count);
+    if (!culled)
+        return;
+
+    ctx->culled_widgets += count;
+    UI_STAT(if (ctx->stats.num_windows > 0) ctx->window_stats[ctx->stats.num_windows - 1].culled_widgets += count);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// same as cull_widget for a row of [count] widgets drawn at once (ui_knob_bank), each one is counted in the stats
+static inline bool cull_widgets(ui_context* ctx, float height, uint32_t count)
+{
+    dirty_begin_segment(ctx, ctx->current_window->id, ++ctx->dirty_index);
+    bool culled = !(ctx->layout.y + height > ctx->clip.y && ctx->layout.y < ctx->clip.y + ctx->clip.height);
+    count_widgets(ctx, count, culled);
+    return culled;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns true if the widget rows starting at the layout are outside of the clip rect, the widget has to skip
+// formatting and drawing but still advance the layout
+static inline bool cull_widget(ui_context* ctx, float height)
+{
+    return cull_widgets(ctx, height, 1);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// keeps track of the bytes written in the string buffer by printf
+static inline void count_formatted(ui_context* ctx, int length)
+{
+#if UI_STATS
+    if (length > 0)
+        ctx->stats.bytes_formatted += (length < STRING_BUFFER_SIZE) ? (uint32_t) length : STRING_BUFFER_SIZE - 1;
+#else
+    (void) ctx; (void) length;
+#endif
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline void draw_disc(ui_context* ctx, float x, float y, float radius, uint32_t srgb_color)
+{
+    render_box(ctx, x - radius, y - radius, radius*2.f, radius*2.f, radius, srgb_color);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Numbers formatting, locale-free and without going through vsnprintf
+//-----------------------------------------------------------------------------------------------------------------------------
+
+static const double format_pow10[FORMAT_MAX_PRECISION + 1] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// writes the digits backward, returns the first character
+static inline char* format_digits(char* end, uint64_t value)
+{
+    do
+    {
+        *--end = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    return end;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// copies the number and the optional unit in the string buffer
+static inline const char* format_output(ui_context* ctx, const char* number, size_t length, const char* unit)
+{
+    size_t unit_length = (unit != NULL) ? strlen(unit) : 0;
+    if (length + unit_length >= STRING_BUFFER_SIZE)
+        unit_length = STRING_BUFFER_SIZE - 1 - length;
+
+    memmove(ctx->string_buffer, number, length);
+    if (unit_length > 0)
+        memcpy(ctx->string_buffer + length, unit, unit_length);
+    ctx->string_buffer[length + unit_length] = 0;
+    UI_STAT(ctx->stats.bytes_formatted += (uint32_t) (length + unit_length));
+    return ctx->string_buffer;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static const char* format_int(ui_context* ctx, int32_t value, const char* unit)
+{
+    char digits[16];
+    char* end = digits + sizeof(digits);
+    char* first = format_digits(end, (value < 0) ? (uint64_t)(-(int64_t)value) : (uint64_t)value);
+    if (value < 0)
+        *--first = '-';
+
+    return format_output(ctx, first, (size_t)(end - first), unit);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Same output as printf("%.*f"), a float multiplied by a power of ten up to 1e9 is exact in double so the rounding
+// to nearest-even is done on the exact value. Very large values fall back on snprintf.
+static const char* format_float(ui_context* ctx, float value, uint32_t precision, const char* unit)
+{
+    char digits[40];
+    char* end = digits + sizeof(digits);
+    char* first = end;
+
+    precision = (precision > FORMAT_MAX_PRECISION) ? FORMAT_MAX_PRECISION : precision;
+    double scaled = fabs((double)value) * format_pow10[precision];
+
+    if (isnan(value))
+        first = memcpy(end - 3, "nan", 3);
+    else if (isinf(value))
+        first = memcpy(end - 3, "inf", 3);
+    else if (scaled >= 1e18)
+    {
+        int length = snprintf(ctx->string_buffer, STRING_BUFFER_SIZE, "%.*f", (int)precision, (double)value);
+        return format_output(ctx, ctx->string_buffer, (size_t)length, unit);
+    }
+    else
+    {
+        double integer = floor(scaled);
+        uint64_t rounded = (uint64_t)integer;
+        double remainder = scaled - integer;
+        if (remainder > .5 || (remainder == .5 && (rounded & 1)))
+            rounded++;
+
+        uint64_t divisor = (uint64_t)format_pow10[precision];
+        if (precision > 0)
+        {
+            uint64_t fraction = rounded % divisor;
+            for(uint32_t i=0; i<precision; ++i, fraction /= 10)
+                *--first = (char)('0' + fraction % 10);
+            *--first = '.';
+        }
+        first = format_digits(first, rounded / divisor);
+    }
+
+    if (signbit(value))
+        *--first = '-';
+
+    return format_output(ctx, first, (size_t)(end - first), unit);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// UI functions
+//-----------------------------------------------------------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------------------------------------------------------
+size_t ui_min_memory_size(void)
+{
+    return sizeof(ui_context);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+ui_context* ui_init(const ui_def* def)
+{
+    assert(HAS_TEXT_WIDTH(def));
+    assert(def->command_buffer != NULL || HAS_DRAW_CALLBACKS(def));
+    
+    assert(((uintptr_t)def->preallocated_buffer)%sizeof(uintptr_t) == 0);
+    assert(((uintptr_t)def->command_buffer)%sizeof(uintptr_t) == 0);
+
+    ui_context* ctx = (ui_context*)def->preallocated_buffer;
+    *ctx = (ui_context)
+    {
+        .mouse_button = button_idle,
+        .font_height = def->font_height,
+        .renderer = def->renderer_callbacks,
+        .command_buffer = (uint8_t*) def->command_buffer,
+        .command_buffer_size = def->command_buffer_size,
+        .command_text_offset = def->command_buffer_size,
+        .get_time = def->get_time,
+        .track_dirty_rects = def->track_dirty_rects,
+        .clip = {0.f, 0.f, (float)UINT16_MAX, (float)UINT16_MAX},
+        .padding = fmaxf(def->font_height/4.f, 2.f),
+        .corner = fmaxf(def->font_height/2.f, 2.f),
+        .colors = 
+        {
+            .window_bg = 0xFFF7F0E9,
+            .window_border = 0xFFE3CDB8,
+            .title_bg = 0xFFE5C4A8,
+            .title_text = 0xFF402A1B,
+            .widget_bg = 0xFFF4E6D8,
+            .widget_hover = 0xFFEEDBC3,
+            .widget_active = 0xFFE7CCB0,
+            .text = 0xFF553E2C,
+            .accent = 0xFFE68B3E,
+            .value_bg = 0xFFEDE6DE,
+            .value_text = 0xFF1E1E1E,
+            .separator = 0x40553E2C
+        }
+    };
+    ctx->row_height = ctx->font_height * 1.5f;
+    init_color_tables(ctx);
+    init_palettes(ctx);
+
+    for(uint32_t i=0; i<=KNOB_SWEEP_STEPS; ++i)
+    {
+        float angle = KNOB_MIN_ANGLE + (KNOB_MAX_ANGLE - KNOB_MIN_ANGLE) * (float) i / (float) KNOB_SWEEP_STEPS;
+        ctx->knob_sweep[i] = (ui_vec2) {cosf(angle), sinf(angle)};
+    }
+    return ctx;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_update_mouse_pos(ui_context* ctx, float x, float y)
+{
+    ctx->mouse_pos = (ui_vec2) {x, y};
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_update_mouse_button(ui_context* ctx, enum ui_button_state button)
+{
+    ctx->mouse_button = button;
+
+    if (button == button_pressed)
+    {
+        ctx->mouse_down = true;
+        ctx->mouse_doubleclick = (ctx->doubleclick_timer < 0.25f);
+        ctx->doubleclick_timer = 0.f;
+    }
+    else
+    {
+        ctx->mouse_down = false;
+        ctx->mouse_doubleclick = false;
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_update_mouse_wheel(ui_context* ctx, float delta)
+{
+    ctx->mouse_wheel += delta;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the slot of the window [id] in the table, or the empty slot ending the probing. Windows are never removed.
+static inline uint32_t find_window_slot(const ui_context* ctx, uint32_t id)
+{
+    uint32_t slot = id % WINDOW_TABLE_SIZE;
+    while (ctx->window_table[slot] != 0 && ctx->windows[ctx->window_table[slot] - 1].id != id)
+        slot = (slot + 1) % WINDOW_TABLE_SIZE;
+    return slot;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the index of the topmost window under the mouse with the rects of the last frame, -1 if none
+static int32_t hovered_window(const ui_context* ctx)
+{
+    int32_t hovered = -1;
+    for(uint32_t i=0; i<ctx->num_windows; ++i)
+    {
+        const ui_window* w = &ctx->windows[i];
+        ui_rect rect = {w->pos.x, w->pos.y, w->width, w->height};
+        if (w->last_frame == ctx->frame_index && in_rect(&rect, ctx->mouse_pos) && (hovered < 0 || w->z > ctx->windows[hovered].z))
+            hovered = (int32_t) i;
+    }
+    return hovered;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_copy_input(ui_context* ctx, const ui_context* src)
+{
+    ctx->mouse_pos = src->mouse_pos;
+    ctx->mouse_button = src->mouse_button;
+    ctx->mouse_down = src->mouse_down;
+    ctx->mouse_doubleclick = src->mouse_doubleclick;
+    ctx->mouse_wheel = src->mouse_wheel;
+
+    // the windows merged in src during its last frame take their stacking order from src
+    ctx->shared_input = false;
+    for(uint32_t i=0; i<ctx->num_windows; ++i)
+    {
+        uint32_t index = src->window_table[find_window_slot(src, ctx->windows[i].id)];
+        if (index != 0 && src->windows[index - 1].last_frame == src->frame_index)
+        {
+            ctx->windows[i].z = src->windows[index - 1].z;
+            ctx->shared_input = true;
+        }
+    }
+
+    // same input window as src, the topmost of all the contexts merged in src
+    if (ctx->shared_input)
+    {
+        int32_t hovered = hovered_window(src);
+        const ui_window* input = (src->mouse_down && src->mouse_button != button_pressed) ? src->pressed_window :
+                                 (hovered >= 0) ? &src->windows[hovered] : NULL;
+        ctx->has_shared_input_window = input != NULL;
+        ctx->shared_input_id = (input != NULL) ? input->id : 0;
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_begin_frame(ui_context* ctx, float delta_time)
+{
+    ctx->current_window = NULL;
+
+    // all timers at once, the loop is vectorized
+    ui_animation_pool* pool = &ctx->animations;
+    for(uint32_t i=0; i<pool->count; ++i)
+        pool->t[i] = fminf(1.f, pool->t[i] + delta_time * pool->speed[i]);
+
+    ctx->doubleclick_timer += delta_time;
+    ctx->input_received = ctx->mouse_pos.x != ctx->last_mouse_pos.x || ctx->mouse_pos.y != ctx->last_mouse_pos.y ||
+                          ctx->mouse_button != button_idle || ctx->mouse_wheel != 0.f;
+    ctx->last_mouse_pos = ctx->mouse_pos;
+    ctx->num_commands = 0;
+    ctx->command_text_offset = ctx->command_buffer_size;
+
+    // topmost window under the mouse, a click brings it to the front. The stacking order of merged windows is
+    // changed by the context they are merged in.
+    int32_t hovered_index = hovered_window(ctx);
+    ui_window* hovered = (hovered_index >= 0) ? &ctx->windows[hovered_index] : NULL;
+    if (ctx->mouse_button == button_pressed)
+    {
+        ctx->pressed_window = hovered;
+        if (hovered != NULL && ctx->command_buffer != NULL && !ctx->shared_input)
+            hovered->z = ++ctx->z_counter;
+    }
+
+    ctx->input_window = (ctx->mouse_down) ? ctx->pressed_window : hovered;
+    if (ctx->shared_input)
+    {
+        uint32_t index = ctx->window_table[find_window_slot(ctx, ctx->shared_input_id)];
+        ctx->input_window = (ctx->has_shared_input_window && index != 0) ? &ctx->windows[index - 1] : NULL;
+    }
+
+    // with the renderer callbacks the windows are drawn in call order, the z of a window is its rank in the frame
+    if (ctx->command_buffer == NULL)
+        ctx->z_counter = 0;
+    ctx->frame_index++;
+    ctx->culled_widgets = 0;
+
+    // the segments of the frame before the last one are overwritten
+    ctx->dirty_frame ^= 1;
+    ctx->num_dirty_segments[ctx->dirty_frame] = 0;
+    ctx->dirty_index = 0;
+    dirty_begin_segment(ctx, 0, 0);
+    UI_STAT(ctx->stats = (ui_frame_stats) {.windows = ctx->window_stats});
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+uint32_t ui_id(const char* name)
+{
+    return ui_hash(name, strlen(name));
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns true if the window is covered by a single window above, the rounded corners of the covering window are
+// not opaque so its rect is shrunk by the corner radius
+static bool window_occluded(const ui_context* ctx, const ui_window* w)
+{
+    for(uint32_t i=0; i<ctx->num_windows; ++i)
+    {
+        const ui_window* o = &ctx->windows[i];
+        if (o->z <= w->z || o->last_frame + 1 < ctx->frame_index)
+            continue;
+
+        if (w->pos.x >= o->pos.x + ctx->corner && w->pos.y >= o->pos.y + ctx->corner &&
+            w->pos.x + w->width <= o->pos.x + o->width - ctx->corner && w->pos.y + w->height <= o->pos.y + o->height - ctx->corner)
+            return true;
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// the stacking order changes what is visible without changing the primitives, the windows above and overlapping
+// are part of the chrome segment
+static void dirty_windows_above(ui_context* ctx, const ui_window* w)
+{
+    for(uint32_t i=0; i<ctx->num_windows; ++i)
+    {
+        const ui_window* o = &ctx->windows[i];
+        if (o->z <= w->z || o->last_frame + 1 < ctx->frame_index || o->pos.x > w->pos.x + w->width ||
+            o->pos.y > w->pos.y + w->height || o->pos.x + o->width < w->pos.x || o->pos.y + o->height < w->pos.y)
+            continue;
+
+        dirty_primitive(ctx, &o->id, sizeof(o->id), w->pos.x, w->pos.y, w->pos.x + w->width, w->pos.y + w->height);
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_begin_window(ui_context* ctx, const char* name, float x, float y, float width, float height, uint32_t options)
+{
+    ui_begin_window_id(ctx, ui_hash(name, strlen(name)), name, x, y, width, height, options);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_begin_window_id(ui_context* ctx, uint32_t id, const char* name, float x, float y, float width, float height, uint32_t options)
+{
+    assert(ctx->current_window == NULL);
+
+    // already created?
+    uint32_t slot = find_window_slot(ctx, id);
+    if (ctx->window_table[slot] != 0)
+        ctx->current_window = &ctx->windows[ctx->window_table[slot] - 1];
+
+    // not found, create one
+    if (ctx->current_window == NULL)
+    {
+        assert(ctx->num_windows < MAX_WINDOWS);
+        ctx->window_table[slot] = (uint16_t) (ctx->num_windows + 1);
+        ctx->current_window = &ctx->windows[ctx->num_windows++];
+        *ctx->current_window = (ui_window)
+        {
+            .name = name,
+            .id = id,
+            .pos = {.x = x, .y = y},
+            .min_width = measure_text(ctx, name) + ctx->padding * 2.f,
+            .min_height = ctx->row_height * 2.f,
+            .width = width,
+            .height = height,
+            .options = options,
+            .z = ++ctx->z_counter,
+            .closed = false
+        };
+    }
+    else if (ctx->command_buffer == NULL)
+        ctx->current_window->z = ++ctx->z_counter;
+
+    ui_window* w = ctx->current_window;
+
+    // only the input window sees the mouse
+    if (w != ctx->input_window)
+    {
+        ctx->hidden_mouse = (ui_mouse_state) {ctx->mouse_pos, ctx->mouse_button, ctx->mouse_down, ctx->mouse_doubleclick, ctx->mouse_wheel};
+        ctx->mouse_pos = (ui_vec2) {-FLT_MAX, -FLT_MAX};
+        ctx->mouse_button = button_idle;
+        ctx->mouse_down = ctx->mouse_doubleclick = false;
+        ctx->mouse_wheel = 0.f;
+        ctx->mouse_hidden = true;
+    }
+
+    ctx->occluded = window_occluded(ctx, w);
+    w->last_frame = ctx->frame_index;
+    w->command_offset = ctx->num_commands;
+
+    ctx->dirty_index = 0;
+    dirty_begin_segment(ctx, w->id, 0);
+    if (ctx->track_dirty_rects)
+        dirty_windows_above(ctx, w);
+
+#if UI_STATS
+    if (ctx->stats.num_windows < MAX_WINDOWS)
+        ctx->window_stats[ctx->stats.num_windows++] = (ui_window_stats) {.name = w->name};
+    if (ctx->get_time != NULL)
+        ctx->window_start_time = ctx->get_time();
+#endif
+
+    // resize
+    ui_rect handle_rect = {w->pos.x + w->width - ctx->corner, w->pos.y + w->height - ctx->corner, ctx->corner, ctx->corner};
+    if (ctx->mouse_button == button_pressed && in_rect(&handle_rect, ctx->mouse_pos) && (w->options&window_resizable))
+    {
+        ctx->resizing_window = w;
+        ctx->dragging_offset = ui_vec2_sub(ui_vec2_add(w->pos, (ui_vec2) {w->width, w->height}), ctx->mouse_pos);
+    }
+
+    if (ctx->mouse_down && ctx->resizing_window == w)
+    {
+        w->width = fmaxf(ctx->mouse_pos.x + ctx->dragging_offset.x - w->pos.x, w->min_width);
+        w->height = fmaxf(ctx->mouse_pos.y + ctx->dragging_offset.y - w->pos.y, w->min_height);
+    }
+
+    ui_rect title_rect = {w->pos.x+ctx->padding, w->pos.y+ctx->padding, w->width-ctx->padding*2.f, ctx->row_height};
+
+    // move the window if click on the title bar
+    if (ctx->mouse_button == button_pressed && in_rect(&title_rect, ctx->mouse_pos) &&
+        !(w->options&window_pinned) && ctx->resizing_window != w)
+    {
+        ctx->dragging_object = w;
+        ctx->dragging_offset = ui_vec2_sub(ctx->mouse_pos, w->pos);
+    }
+
+    if (ctx->mouse_down && ctx->dragging_object == w)
+        w->pos = ui_vec2_sub(ctx->mouse_pos, ctx->dragging_offset);
+
+    // border
+    render_box(ctx, w->pos.x, w->pos.y, w->width, w->height, ctx->corner, ctx->colors.window_border);
+
+    // title bg
+    render_box(ctx, title_rect.x, title_rect.y, title_rect.width, title_rect.height, ctx->corner, ctx->colors.title_bg);
+
+    ctx->layout = (ui_rect)
+    {
+        .x = w->pos.x + ctx->padding,
+        .y = title_rect.y + title_rect.height + ctx->padding,
+        .width = w->width - ctx->padding*2.f,
+        .height = ctx->row_height
+    };
+
+    // background
+    render_box(ctx, ctx->layout.x, ctx->layout.y, ctx->layout.width, 
+               w->height - title_rect.height - ctx->padding*3.f, 0, ctx->colors.window_bg);
+    
+    ctx->layout.x += ctx->padding;
+    ctx->layout.width -= 2.f * ctx->padding;
+
+    // title
+    draw_align_text(ctx, &title_rect, w->name, ctx->colors.title_text, align_center);
+
+    // draw resize handle
+    if (w->options&window_resizable)
+        render_box(ctx, handle_rect.x, handle_rect.y, handle_rect.width, handle_rect.height, 0.f, ctx->colors.separator);
+
+    // clip rect
+    uint16_t clip_minx = (uint16_t) fmaxf(ctx->layout.x, 0.f);
+    uint16_t clip_miny = (uint16_t) fmaxf(ctx->layout.y, 0.f);
+    uint16_t clip_maxx = (uint16_t) (ctx->layout.x + ctx->layout.width + .5f);
+    uint16_t clip_maxy = (uint16_t) (w->pos.y + w->height - ctx->padding + .5f);
+    render_clip_rect(ctx, clip_minx, clip_miny, clip_maxx, clip_maxy);
+    ctx->clip = (ui_rect) {clip_minx, clip_miny, (float)clip_maxx - clip_minx, (float)clip_maxy - clip_miny};
+
+    // all the widgets of an occluded window are culled
+    if (ctx->occluded)
+        ctx->clip = (ui_rect) {0.f, -FLT_MAX, 0.f, 0.f};
+
+    // scrolling, the content height is known from the previous frame
+    ctx->content_y = ctx->layout.y;
+    if (w->options&window_scrollable)
+    {
+        ui_rect window_rect = {w->pos.x, w->pos.y, w->width, w->height};
+        if (ctx->mouse_wheel != 0.f && in_rect(&window_rect, ctx->mouse_pos))
+        {
+            w->scroll -= ctx->mouse_wheel * ctx->row_height * SCROLL_ROWS_PER_WHEEL_STEP;
+            ctx->mouse_wheel = 0.f;
+        }
+
+        w->scroll = clamp_float(0.f, fmaxf(w->content_height - ctx->clip.height, 0.f), w->scroll);
+        ctx->layout.y -= w->scroll;
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_text(ui_context* ctx, enum ui_text_alignment alignment, const char* string, ...)
+{
+    assert(ctx->current_window != NULL);
+
+    if (cull_widget(ctx, ctx->layout.height))
+        return;
+
+    // no format expression, no need to copy the string
+    if (strchr(string, '%') == NULL)
+    {
+        draw_align_text(ctx, &ctx->layout, string, ctx->colors.text, alignment);
+        return;
+    }
+
+    va_list args;
+    va_start(args, string);
+    count_formatted(ctx, vsnprintf(ctx->string_buffer, STRING_BUFFER_SIZE, string, args));
+    va_end(args);
+
+    draw_align_text(ctx, &ctx->layout, ctx->string_buffer, ctx->colors.text, alignment);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_newline(ui_context* ctx)
+{
+    assert(ctx->current_window != NULL);
+    ctx->layout.x = ctx->current_window->pos.x + ctx->padding * 2.f;
+    ctx->layout.y += ctx->layout.height;
+    ctx->layout.width = ctx->current_window->width - ctx->padding * 4.f;
+    ctx->layout.height = ctx->row_height;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_separator(ui_context* ctx)
+{
+    assert(ctx->current_window != NULL);
+
+    if (!cull_widget(ctx, ctx->layout.height))
+    {
+        float y = ctx->layout.y + .5f * ctx->layout.height;
+        render_box(ctx, ctx->layout.x, y, ctx->layout.width, 1.f, 1.f, ctx->colors.separator);
+    }
+    ui_newline(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void value_row(ui_context* ctx, const char* label, const char* text)
+{
+    ui_rect value_rect = {ctx->layout.x + ctx->layout.width*.5f, ctx->layout.y, ctx->layout.width*.5f, ctx->layout.height};
+
+    render_text(ctx, ctx->layout.x, ctx->layout.y, label, ctx->colors.text);
+    render_box(ctx, value_rect.x, value_rect.y, value_rect.width, value_rect.height, 0, ctx->colors.value_bg);
+    render_box(ctx, value_rect.x-0.5f, value_rect.y+ctx->padding, 1.f, value_rect.height-ctx->padding*2, 0, ctx->colors.separator);
+
+    draw_align_text(ctx, &value_rect, text, ctx->colors.value_text, align_right);
+    ui_newline(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_value(ui_context* ctx, const char* label, const char* fmt, ...)
+{
+    assert(ctx->current_window != NULL);
+
+    if (cull_widget(ctx, ctx->layout.height))
+    {
+        ui_newline(ctx);
+        return;
+    }
+
+    if (strchr(fmt, '%') == NULL)
+    {
+        value_row(ctx, label, fmt);
+        return;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    count_formatted(ctx, vsnprintf(ctx->string_buffer, STRING_BUFFER_SIZE, fmt, args));
+    va_end(args);
+
+    value_row(ctx, label, ctx->string_buffer);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_value_float(ui_context* ctx, const char* label, float value, uint32_t precision, const char* unit)
+{
+    assert(ctx->current_window != NULL);
+
+    if (cull_widget(ctx, ctx->layout.height))
+    {
+        ui_newline(ctx);
+        return;
+    }
+
+    value_row(ctx, label, format_float(ctx, value, precision, unit));
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_value_int(ui_context* ctx, const char* label, int32_t value, const char* unit)
+{
+    assert(ctx->current_window != NULL);
+
+    if (cull_widget(ctx, ctx->layout.height))
+    {
+        ui_newline(ctx);
+        return;
+    }
+
+    value_row(ctx, label, format_int(ctx, value, unit));
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_toggle(ui_context* ctx, const char* label, bool* value)
+{
+    const void* key = widget_key(ctx, value);
+    if (cull_widget(ctx, ctx->layout.height))
+    {
+        ui_newline(ctx);
+        return;
+    }
+
+    draw_align_text(ctx, &ctx->layout, label, ctx->colors.text, align_left);
+
+    ui_rect track_rect = 
+    {
+        .x = ctx->layout.x + ctx->layout.width - ctx->font_height*2.f - ctx->padding,
+        .y = ctx->layout.y+ctx->padding,
+        .width = ctx->font_height*2.f,
+        .height = ctx->font_height
+    };
+
+    if (in_rect(&track_rect, ctx->mouse_pos) && ctx->mouse_button == button_pressed)
+    {
+        *value = !(*value);
+
+        // setup tweening animation, animate thumb position and track color
+        uint32_t index = start_tween(ctx, key, track_rect.x + ctx->font_height - 2.f, track_rect.x + 2.f);
+        ctx->animations.color_key0[index] = ctx->colors.accent;
+        ctx->animations.color_key1[index] = ctx->colors.separator;
+        ctx->animations.key0_to_key1[index] = !(*value);
+    }
+
+    ui_rect thumb_rect =
+    {
+        .x = (*value) ? track_rect.x + ctx->font_height - 2.f : track_rect.x + 2.f,
+        .y = track_rect.y + 2.f,
+        .width = ctx->font_height - 4.f,
+        .height = ctx->font_height - 4.f
+    };
+
+    uint32_t track_color;
+    int32_t anim = find_animation(ctx, key, animation_tween);
+    if (anim >= 0)
+    {
+        const ui_animation_pool* pool = &ctx->animations;
+        float t = (pool->key0_to_key1[anim]) ? pool->t[anim] : 1.f - pool->t[anim];
+        thumb_rect.x = lerp_float(pool->value_key0[anim], pool->value_key1[anim], t);
+        track_color = lerp_color(ctx, pool->color_key0[anim], pool->color_key1[anim], t);
+    }
+    else
+        track_color = (*value) ? ctx->colors.accent : ctx->colors.separator;
+
+    
+    render_box(ctx, track_rect.x, track_rect.y, track_rect.width, track_rect.height,
+               track_rect.height*.5f, track_color);
+
+    if (in_rect(&track_rect, ctx->mouse_pos))
+        expand_rect(&thumb_rect, 1.f);
+    
+    render_box(ctx, thumb_rect.x, thumb_rect.y, thumb_rect.width, thumb_rect.height,
+                thumb_rect.height*.5f, ctx->colors.text);
+
+    ui_newline(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_segmented(ui_context* ctx, const char** entries, uint32_t num_entries, uint32_t* selected)
+{
+    const void* key = widget_key(ctx, selected);
+    if (cull_widget(ctx, ctx->layout.height))
+    {
+        ui_newline(ctx);
+        return;
+    }
+
+    ui_rect seg_rect = 
+    {
+        .x = ctx->layout.x,
+        .y = ctx->layout.y,
+        .width = ctx->layout.width / (float)num_entries,
+        .height = ctx->font_height
+    };
+
+    render_box(ctx, seg_rect.x, seg_rect.y + ctx->padding, ctx->layout.width, seg_rect.height,
+               ctx->corner, ctx->colors.widget_bg);
+    
+    if (*selected < num_entries)
+    {
+        int32_t anim = find_animation(ctx, key, animation_tween);
+        float x = (anim >= 0) ? 
+                    lerp_float(ctx->animations.value_key0[anim], ctx->animations.value_key1[anim], ease_out_back(ctx->animations.t[anim])) : 
+                    seg_rect.x + seg_rect.width * (*selected);
+
+        render_box(ctx, x + ctx->padding, seg_rect.y + ctx->padding, seg_rect.width - 2.f * ctx->padding,
+                   seg_rect.height, ctx->padding, ctx->colors.accent);
+    }
+
+    for(uint32_t i=0; i<num_entries; ++i)
+    {
+        ui_rect button_rect = seg_rect; button_rect.y += ctx->padding;
+        if (in_rect(&button_rect, ctx->mouse_pos))
+        {
+            if (ctx->mouse_button == button_pressed)
+            {
+                start_tween(ctx, key, ctx->layout.x + seg_rect.width * (*selected), ctx->layout.x + seg_rect.width * i);
+
+                *selected = i;
+            }
+            else if (i != *selected)
+            {
+                render_box(ctx, seg_rect.x, seg_rect.y + ctx->padding, seg_rect.width, seg_rect.height, 
+                          ctx->padding, ctx->colors.widget_hover);
+            }
+        }
+
+        draw_align_text(ctx, &seg_rect, entries[i], ctx->colors.text, align_center);
+
+        if (i>0) // separator
+            render_box(ctx, seg_rect.x-.5f, seg_rect.y+ctx->padding*2.f, 1.f, seg_rect.height-2.f*ctx->padding,
+                       0, ctx->colors.separator);
+
+        seg_rect.x += seg_rect.width;
+    }
+    ui_newline(ctx);
+}
+
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// [fmt] printf-style format or NULL to use the fast formatting with [precision] and [unit]
+static void slider(ui_context* ctx, const char* label, float min_value, float max_value, float step, float* value,
+                   const char* fmt, uint32_t precision, const char* unit)
+{
+    assert(max_value>min_value);
+    const void* key = widget_key(ctx, value);
+
+    // always clamp in case the user change the value
+    *value = clamp_float(min_value, max_value, *value);
+
+    // label row + track row
+    if (cull_widget(ctx, ctx->layout.height + ctx->row_height))
+    {
+        ui_newline(ctx);
+        ui_newline(ctx);
+        return;
+    }
+
+    // first row is just label + value
+    const char* text = (fmt != NULL) ? ctx->string_buffer : format_float(ctx, *value, precision, unit);
+    if (fmt != NULL)
+        count_formatted(ctx, snprintf(ctx->string_buffer, STRING_BUFFER_SIZE, fmt, *value));
+
+    draw_align_text(ctx, &ctx->layout, label, ctx->colors.text, align_left);
+    draw_align_text(ctx, &ctx->layout, text, ctx->colors.text, align_right);
+    ui_newline(ctx);
+
+    float center_y = ctx->layout.y + .5f * ctx->layout.height;
+
+    // track
+    ui_rect track_rect = 
+    { 
+        .x = ctx->layout.x + .1f * ctx->layout.width,
+        .y = center_y - ctx->padding*.5f,
+        .width = .8f * ctx->layout.width,
+        .height = ctx->padding
+    };
+
+    // thumb geometry
+    float norm_value = (*value - min_value) / (max_value - min_value);
+    float thumb_x = norm_value * track_rect.width + track_rect.x;
+    float thumb_size = ctx->font_height - 4.f;
+    float half_size = thumb_size * .5f;
+
+    ui_rect thumb_rect = 
+    {
+        .x = thumb_x - half_size,
+        .y = center_y - half_size,
+        .width = thumb_size,
+        .height = thumb_size
+    };
+
+    const bool track_hovered = in_rect(&track_rect, ctx->mouse_pos);
+    const bool thumb_hovered = in_rect(&thumb_rect, ctx->mouse_pos);
+
+    // track change color on mouse-over
+    uint32_t track_color = (track_hovered || (ctx->dragging_object == key)) ? ctx->colors.widget_hover : ctx->colors.widget_bg;
+    render_box(ctx, track_rect.x, track_rect.y, track_rect.width, track_rect.height,
+               track_rect.height*.5f, track_color);
+
+    // thumb mouse-over and dragging
+    if (thumb_hovered)
+    {
+        expand_rect(&thumb_rect, 2.f);
+        if (ctx->mouse_button == button_pressed)
+        {
+            ctx->dragging_object = key;
+            ctx->dragging_offset.x = ctx->mouse_pos.x - thumb_x;
+        }
+    }
+    else if (track_hovered && ctx->mouse_button == button_pressed)
+    {
+        // click on track make the thumb move
+        start_tween(ctx, key, thumb_x, ctx->mouse_pos.x);
+
+        if (ctx->dragging_object == key)
+            ctx->dragging_object = NULL;
+    }
+
+    // click-on-track update
+    int32_t anim = find_animation(ctx, key, animation_tween);
+    if (anim >= 0)
+        thumb_x = lerp_float(ctx->animations.value_key0[anim], ctx->animations.value_key1[anim], ctx->animations.t[anim]);
+
+    // drag update
+    if (ctx->mouse_down && ctx->dragging_object == key)
+        thumb_x = ctx->mouse_pos.x - ctx->dragging_offset.x;
+
+    thumb_x = clamp_float(track_rect.x, track_rect.x + track_rect.width, thumb_x);
+    norm_value = (thumb_x - track_rect.x) / track_rect.width;
+    *value = norm_value * (max_value - min_value) + min_value;
+    *value = (step>0.f) ? roundf(*value / step) * step : *value;
+
+    render_box(ctx, thumb_rect.x, thumb_rect.y, thumb_rect.width, thumb_rect.height, half_size,
+               ctx->colors.accent);
+
+    ui_newline(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_slider(ui_context* ctx, const char* label, float min_value, float max_value, float step, float* value, const char* fmt)
+{
+    slider(ctx, label, min_value, max_value, step, value, fmt, 0, NULL);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_slider_float(ui_context* ctx, const char* label, float min_value, float max_value, float step, float* value,
+                     uint32_t precision, const char* unit)
+{
+    slider(ctx, label, min_value, max_value, step, value, NULL, precision, unit);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+bool ui_button(ui_context* ctx, const char* label, enum ui_text_alignment alignment)
+{
+    const void* key = widget_key(ctx, label);
+    if (cull_widget(ctx, ctx->row_height))
+        return false;
+
+    bool clicked = false;
+    float text_width = measure_text(ctx, label);
+
+    ui_rect button_rect = {.y = ctx->layout.y, .height = ctx->row_height, .width = text_width + 2.f * ctx->padding};
+
+    switch(alignment)
+    {
+    case align_left: button_rect.x = ctx->layout.x; break;
+    case align_center: button_rect.x = ctx->layout.x + ctx->layout.width * .5f - button_rect.width * .5f; break;
+    default: button_rect.x = ctx->layout.x + ctx->layout.width - button_rect.width; break;
+    }
     
-    ctx->renderer.draw_box(track_rect.x, track_rect.y, track_rect.width, track_rect.height,
-                           track_rect.height*.5f, track_color, ctx->renderer.user);
+    ui_vec2 text_pos = {button_rect.x + ctx->padding, button_rect.y + button_rect.height * .5f - ctx->font_height + ctx->padding};
+    uint32_t button_color = ctx->colors.widget_bg;
+    int32_t anim = find_animation(ctx, key, animation_tween);
+    if (anim >= 0)
+    {
+        button_color = lerp_color(ctx, ctx->colors.accent, ctx->colors.window_bg, ease_in_expo(ctx->animations.t[anim]));
+        expand_rect(&button_rect, -ease_impulse(ctx->animations.t[anim]) * 2.f);
+    }
+    else if (in_rect(&button_rect, ctx->mouse_pos))
+    {
+        if (ctx->mouse_button == button_pressed)
+        {
+            clicked = true;
+            start_animation(ctx, key, animation_tween, ANIMATION_DURATION);
+        }
+        else
+        {
+            // the hover fade is evicted as soon as the mouse leaves the button
+            int32_t hover = find_animation(ctx, key, animation_hover);
+            if (hover >= 0)
+                button_color = lerp_color(ctx, ctx->colors.widget_bg, ctx->colors.widget_hover, ctx->animations.t[hover]);
+            else
+                start_animation(ctx, key, animation_hover, HOVER_DURATION);
+        }
+    }
+
+    // border
+    render_box(ctx, button_rect.x, button_rect.y, button_rect.width, button_rect.height, 
+               ctx->corner, ctx->colors.separator);
+
+    expand_rect(&button_rect, -1.f);
+
+    render_box(ctx, button_rect.x, button_rect.y, button_rect.width, button_rect.height, 
+               ctx->corner, button_color);
+
+    render_text(ctx, text_pos.x, text_pos.y, label, ctx->colors.text);
+
+    return clicked;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_knob(ui_context* ctx, const char* label, float min_value, float max_value, float default_value, float* value)
+{
+    const void* key = widget_key(ctx, value);
+
+    // knob needs more space
+    ctx->layout.height = ctx->row_height * 2.f;
+
+    float width = ctx->layout.height * 2.f;
+    if (cull_widget(ctx, ctx->layout.height))
+    {
+        ctx->layout.x += width;
+        ctx->layout.width -= width;
+        return;
+    }
+
+    float text_width = measure_text(ctx, label);
+    float cx = ctx->layout.x + width * .5f;
+    float cy = ctx->layout.y + ctx->layout.height * .25f + ctx->padding;
+    float radius = ctx->layout.height * .25f;
+
+    ui_rect knob_rect = {.x = cx - radius, .y = cy - radius, .width = radius * 2.f, .height = radius * 2.f};
+    bool hovered = in_rect(&knob_rect, ctx->mouse_pos);
+
+    if (hovered && ctx->mouse_button == button_pressed)
+    {
+        ctx->dragging_object = key;
+        ctx->dragging_offset.y = ctx->mouse_pos.y;
+        ctx->dragging_value = *value;
+    }
+
+    bool active = ctx->dragging_object == key;
+
+    // default value and double click managment
+    if (hovered && ctx->mouse_doubleclick)
+    {
+        start_tween(ctx, key, *value, default_value);
+    }
+
+    int32_t anim = find_animation(ctx, key, animation_tween);
+    if (anim >= 0)
+    {
+        *value = lerp_float(ctx->animations.value_key0[anim], ctx->animations.value_key1[anim], ctx->animations.t[anim]);
+        ctx->dragging_value = *value;
+    }
+    else if (active && ctx->mouse_down)
+    {
+        // if dragging, update the value : the moves are added to the value at the press, not to *value which can
+        // be rounded by the caller between frames
+        float dx = ctx->dragging_offset.y - ctx->mouse_pos.y;
+        ctx->dragging_offset.y = ctx->mouse_pos.y;
+        float sens = ctx->font_height * 12.f;
+        float v = ctx->dragging_value + dx * (max_value - min_value) / sens;
+        v = clamp_float(min_value, max_value, v);
+        ctx->dragging_value = v;
+        *value = v;
+    }
+
+    // draw bound dots
+    float min_angle = KNOB_MIN_ANGLE;
+    float max_angle = KNOB_MAX_ANGLE;
+    float bound_distance = radius * 1.05f;
+    float bound_radius = radius * .1f;
+
+    float bx1 = cx + cosf(min_angle) * bound_distance;
+    float by1 = cy + sinf(min_angle) * bound_distance;
+    float bx2 = cx + cosf(max_angle) * bound_distance;
+    float by2 = cy + sinf(max_angle) * bound_distance;
+
+    draw_disc(ctx, bx1, by1, bound_radius, ctx->colors.separator);
+    draw_disc(ctx, bx2, by2, bound_radius, ctx->colors.separator);
+
+    // knob rendering
+    float inner_radius = radius * .8f;
+    uint32_t knob_color = ctx->colors.widget_bg;
+    if (active)
+        knob_color = ctx->colors.widget_active;
+    else if (hovered)
+        knob_color = ctx->colors.widget_hover;
+
+    draw_disc(ctx, cx, cy, radius, ctx->colors.window_border);
+    draw_disc(ctx, cx, cy, inner_radius, knob_color);
+
+    // draw value mark
+    float t = (*value - min_value) / (max_value - min_value);
+    t = clamp_float(0.f, 1.f, t);
+
+    float angle = min_angle + t * (max_angle - min_angle);
+    float mark_radius = inner_radius * 0.9f;
+    float mx = cosf(angle);
+    float my = sinf(angle);
+    float line_width = ctx->padding / 8.f;
+
+    render_line(ctx, cx, cy, cx + mx * mark_radius, cy + my * mark_radius, line_width, ctx->colors.accent);
+    render_text(ctx, cx - text_width * .5f, cy + ctx->font_height, label, ctx->colors.text);
+
+    ctx->layout.x += width;
+    ctx->layout.width -= width;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Same knobs as ui_knob() : the geometry relative to the center is computed once, the value marks come from the sweep
+// table. The mouse is tested against the only knob it can be over, the tweens of the bank are found in one pass.
+void ui_knob_bank(ui_context* ctx, const char* const* labels, uint32_t num_knobs, uint32_t columns,
+                  float min_value, float max_value, float default_value, float* values)
+{
+    assert(ctx->current_window != NULL);
+    assert(columns > 0);
+
+    // the knobs are identified by their values
+    ctx->widget_key = NULL;
+    if (num_knobs == 0)
+        return;
+
+    float knob_height = ctx->row_height * 2.f;
+    float knob_width = knob_height * 2.f;
+    float radius = knob_height * .25f;
+    float inner_radius = radius * .8f;
+    float mark_radius = inner_radius * .9f;
+    float bound_radius = radius * .1f;
+    float bound_distance = radius * 1.05f;
+    float line_width = ctx->padding / 8.f;
+    const ui_vec2* sweep = ctx->knob_sweep;
+
+    // offsets from the center of a knob
+    float bx1 = sweep[0].x * bound_distance - bound_radius, by1 = sweep[0].y * bound_distance - bound_radius;
+    float bx2 = sweep[KNOB_SWEEP_STEPS].x * bound_distance - bound_radius, by2 = sweep[KNOB_SWEEP_STEPS].y * bound_distance - bound_radius;
+    float center_x = ctx->layout.x + knob_width * .5f;
+    float center_y = ctx->layout.y + knob_height * .25f + ctx->padding;
+
+    uint32_t num_rows = (num_knobs + columns - 1) / columns;
+    float origin_y = ctx->layout.y;
+
+    // hit-test
+    int32_t hovered = -1;
+    float column = floorf((ctx->mouse_pos.x - ctx->layout.x) / knob_width);
+    float row = floorf((ctx->mouse_pos.y - origin_y) / knob_height);
+    if (column >= 0.f && column < (float) columns && row >= 0.f && row < (float) num_rows && in_rect(&ctx->clip, ctx->mouse_pos))
+    {
+        uint32_t index = (uint32_t) row * columns + (uint32_t) column;
+        ui_rect knob_rect = {.x = center_x + column * knob_width - radius, .y = center_y + row * knob_height - radius,
+                             .width = radius * 2.f, .height = radius * 2.f};
+        if (index < num_knobs && in_rect(&knob_rect, ctx->mouse_pos))
+            hovered = (int32_t) index;
+    }
+
+    if (hovered >= 0 && ctx->mouse_button == button_pressed)
+    {
+        ctx->dragging_object = &values[hovered];
+        ctx->dragging_offset.y = ctx->mouse_pos.y;
+    }
+
+    if (hovered >= 0 && ctx->mouse_doubleclick)
+        start_tween(ctx, &values[hovered], values[hovered], default_value);
+
+    // tweens of the bank
+    ui_animation_pool* pool = &ctx->animations;
+    uintptr_t first_value = (uintptr_t) values, last_value = (uintptr_t) (values + num_knobs);
+    bool animated = false;
+    for(uint32_t i=0; i<pool->count; ++i)
+    {
+        uintptr_t widget = (uintptr_t) pool->widget[i];
+        if (pool->kind[i] == animation_tween && widget >= first_value && widget < last_value)
+        {
+            pool->last_frame[i] = ctx->frame_index;
+            *(float*) pool->widget[i] = lerp_float(pool->value_key0[i], pool->value_key1[i], pool->t[i]);
+            animated |= (pool->widget[i] == ctx->dragging_object);
+        }
+    }
 
-    if (in_rect(&track_rect, ctx->mouse_pos))
-        expand_rect(&thumb_rect, 1.f);
-    
-    ctx->renderer.draw_box(thumb_rect.x, thumb_rect.y, thumb_rect.width, thumb_rect.height,
-                            thumb_rect.height*.5f, ctx->colors.text, ctx->renderer.user);
+    int32_t active = -1;
+    uintptr_t dragged = (uintptr_t) ctx->dragging_object;
+    if (dragged >= first_value && dragged < last_value)
+    {
+        active = (int32_t) ((dragged - first_value) / sizeof(float));
+        if (!animated && ctx->mouse_down)
+        {
+            float dy = ctx->dragging_offset.y - ctx->mouse_pos.y;
+            ctx->dragging_offset.y = ctx->mouse_pos.y;
+            float v = values[active] + dy * (max_value - min_value) / (ctx->font_height * 12.f);
+            values[active] = clamp_float(min_value, max_value, v);
+        }
+    }
+
+    // visible rows
+    float first_row = floorf((ctx->clip.y - origin_y) / knob_height);
+    float last_row = ceilf((ctx->clip.y + ctx->clip.height - origin_y) / knob_height);
+    uint32_t row_begin = (uint32_t) clamp_float(0.f, (float) num_rows, first_row);
+    uint32_t row_end = (uint32_t) clamp_float(0.f, (float) num_rows, last_row);
+    float value_scale = (float) KNOB_SWEEP_STEPS / (max_value - min_value);
+
+    for(uint32_t r=row_begin; r<row_end; ++r)
+    {
+        uint32_t row_first = r * columns;
+        uint32_t row_last = (row_first + columns < num_knobs) ? row_first + columns : num_knobs;
+        ctx->layout.y = origin_y + knob_height * (float) r;
+        if (cull_widgets(ctx, knob_height, row_last - row_first))
+            continue;
+
+        float cy = center_y + knob_height * (float) r;
+        for(uint32_t i=row_first; i<row_last; ++i)
+        {
+            float cx = center_x + knob_width * (float) (i - row_first);
+            render_box(ctx, cx + bx1, cy + by1, bound_radius * 2.f, bound_radius * 2.f, bound_radius, ctx->colors.separator);
+            render_box(ctx, cx + bx2, cy + by2, bound_radius * 2.f, bound_radius * 2.f, bound_radius, ctx->colors.separator);
+
+            uint32_t knob_color = ctx->colors.widget_bg;
+            if ((int32_t) i == active)
+                knob_color = ctx->colors.widget_active;
+            else if ((int32_t) i == hovered)
+                knob_color = ctx->colors.widget_hover;
+
+            draw_disc(ctx, cx, cy, radius, ctx->colors.window_border);
+            draw_disc(ctx, cx, cy, inner_radius, knob_color);
 
+            float step = clamp_float(0.f, (float) KNOB_SWEEP_STEPS, (values[i] - min_value) * value_scale);
+            const ui_vec2* mark = &sweep[(uint32_t) (step + .5f)];
+            render_line(ctx, cx, cy, cx + mark->x * mark_radius, cy + mark->y * mark_radius, line_width, ctx->colors.accent);
+
+            if (labels != NULL)
+                render_text(ctx, cx - measure_text(ctx, labels[i]) * .5f, cy + ctx->font_height, labels[i], ctx->colors.text);
+        }
+    }
+
+    // the knobs of the rows outside of the clip rect are culled widgets, as if drawn with ui_knob
+    uint32_t first_visited = (row_begin * columns < num_knobs) ? row_begin * columns : num_knobs;
+    uint32_t last_visited = (row_end * columns < num_knobs) ? row_end * columns : num_knobs;
+    count_widgets(ctx, num_knobs - (last_visited - first_visited), true);
+
+    // layout after the last row
+    ctx->layout.y = origin_y + knob_height * (float) (num_rows - 1);
+    ctx->layout.height = knob_height;
     ui_newline(ctx);
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-void ui_segmented(ui_context* ctx, const char** entries, uint32_t num_entries, uint32_t* selected)
-{ 
-    ui_rect seg_rect = 
+// Charts : plot, histogram and heatmap, each on its own row with a border and a background
+//-----------------------------------------------------------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns false if the row is culled, [area] is the drawing area inside the background
+static bool begin_chart(ui_context* ctx, float height, ui_rect* area)
+{
+    assert(ctx->current_window != NULL);
+
+    ctx->widget_key = NULL;
+    ctx->layout.height = (height > 0.f) ? height : ctx->row_height * 4.f;
+    if (cull_widget(ctx, ctx->layout.height))
     {
-        .x = ctx->layout.x,
-        .y = ctx->layout.y,
-        .width = ctx->layout.width / (float)num_entries,
-        .height = ctx->font_height
-    };
+        ui_newline(ctx);
+        return false;
+    }
 
-    ctx->renderer.draw_box(seg_rect.x, seg_rect.y + ctx->padding, ctx->layout.width, seg_rect.height,
-                           ctx->corner, ctx->colors.widget_bg, ctx->renderer.user);
-    
-    if (*selected < num_entries)
+    ui_rect rect = {.x = ctx->layout.x, .y = ctx->layout.y, .width = ctx->layout.width, .height = ctx->layout.height - ctx->padding};
+    render_box(ctx, rect.x, rect.y, rect.width, rect.height, ctx->corner, ctx->colors.separator);
+    expand_rect(&rect, -1.f);
+    render_box(ctx, rect.x, rect.y, rect.width, rect.height, ctx->corner, ctx->colors.widget_bg);
+
+    expand_rect(&rect, -ctx->padding);
+    *area = rect;
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void end_chart(ui_context* ctx, const ui_rect* area, const char* label)
+{
+    if (label != NULL)
+        render_text(ctx, area->x, area->y, label, ctx->colors.text);
+
+    ui_newline(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Quantizes [count] values to (value - min_value) * scale + offset, clamped to [0, max_index]
+static void quantize_values(const float* values, uint32_t count, float min_value, float scale, float offset, float max_index, int32_t* indices)
+{
+    uint32_t i = 0;
+
+#if defined(SIMD_SSE2)
+    __m128 vmin = _mm_set1_ps(min_value), vscale = _mm_set1_ps(scale), voffset = _mm_set1_ps(offset);
+    __m128 vzero = _mm_setzero_ps(), vmax = _mm_set1_ps(max_index);
+    for(; i + 4 <= count; i += 4)
     {
-        float x = (ctx->animation.widget == selected) ? 
-                    lerp_float(ctx->animation.value_key0, ctx->animation.value_key1, ease_out_back(ctx->animation.t)) : 
-                    seg_rect.x + seg_rect.width * (*selected);
+        __m128 x = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(values + i), vmin), vscale), voffset);
+        x = _mm_min_ps(_mm_max_ps(x, vzero), vmax);
+        _mm_storeu_si128((__m128i*) (indices + i), _mm_cvttps_epi32(x));
+    }
+#elif defined(SIMD_NEON)
+    float32x4_t vmin = vdupq_n_f32(min_value), vscale = vdupq_n_f32(scale), voffset = vdupq_n_f32(offset);
+    float32x4_t vzero = vdupq_n_f32(0.f), vmax = vdupq_n_f32(max_index);
+    for(; i + 4 <= count; i += 4)
+    {
+        float32x4_t x = vmlaq_f32(voffset, vsubq_f32(vld1q_f32(values + i), vmin), vscale);
+        x = vminq_f32(vmaxq_f32(x, vzero), vmax);
+        vst1q_s32(indices + i, vcvtq_s32_f32(x));
+    }
+#endif
 
-        ctx->renderer.draw_box(x + ctx->padding, seg_rect.y + ctx->padding, seg_rect.width - 2.f * ctx->padding,
-                               seg_rect.height, ctx->padding, ctx->colors.accent, ctx->renderer.user);
+    for(; i<count; ++i)
+    {
+        float x = (values[i] - min_value) * scale + offset;
+        x = (x > 0.f) ? x : 0.f;
+        indices[i] = (int32_t) ((x < max_index) ? x : max_index);
     }
+}
 
-    for(uint32_t i=0; i<num_entries; ++i)
+//-----------------------------------------------------------------------------------------------------------------------------
+// Plot : the samples of a pixel column are reduced to their min and max, the whole blocks of the summary are read
+// instead of their samples. The summary has two levels : blocks of block_size samples and blocks of block_size blocks.
+//-----------------------------------------------------------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// min of [min_source] and max of [max_source], the same array for the samples
+static void reduce_min_max(const float* min_source, const float* max_source, uint32_t count, float* min_value, float* max_value)
+{
+    float result_min = *min_value, result_max = *max_value;
+    uint32_t i = 0;
+
+#if defined(SIMD_SSE2)
+    if (count >= 8)
     {
-        ui_rect button_rect = seg_rect; button_rect.y += ctx->padding;
-        if (in_rect(&button_rect, ctx->mouse_pos))
+        __m128 min0 = _mm_set1_ps(result_min), min1 = min0;
+        __m128 max0 = _mm_set1_ps(result_max), max1 = max0;
+        for(; i + 8 <= count; i += 8)
         {
-            if (ctx->mouse_button == button_pressed)
+            min0 = _mm_min_ps(min0, _mm_loadu_ps(min_source + i));
+            min1 = _mm_min_ps(min1, _mm_loadu_ps(min_source + i + 4));
+            max0 = _mm_max_ps(max0, _mm_loadu_ps(max_source + i));
+            max1 = _mm_max_ps(max1, _mm_loadu_ps(max_source + i + 4));
+        }
+        float lanes_min[4], lanes_max[4];
+        _mm_storeu_ps(lanes_min, _mm_min_ps(min0, min1));
+        _mm_storeu_ps(lanes_max, _mm_max_ps(max0, max1));
+        for(uint32_t lane=0; lane<4; ++lane)
+        {
+            result_min = (lanes_min[lane] < result_min) ? lanes_min[lane] : result_min;
+            result_max = (lanes_max[lane] > result_max) ? lanes_max[lane] : result_max;
+        }
+    }
+#elif defined(SIMD_NEON)
+    if (count >= 8)
+    {
+        float32x4_t min0 = vdupq_n_f32(result_min), min1 = min0;
+        float32x4_t max0 = vdupq_n_f32(result_max), max1 = max0;
+        for(; i + 8 <= count; i += 8)
+        {
+            min0 = vminq_f32(min0, vld1q_f32(min_source + i));
+            min1 = vminq_f32(min1, vld1q_f32(min_source + i + 4));
+            max0 = vmaxq_f32(max0, vld1q_f32(max_source + i));
+            max1 = vmaxq_f32(max1, vld1q_f32(max_source + i + 4));
+        }
+        result_min = vminvq_f32(vminq_f32(min0, min1));
+        result_max = vmaxvq_f32(vmaxq_f32(max0, max1));
+    }
+#endif
+
+    // no NaN, comparisons instead of the fminf/fmaxf calls
+    for(; i<count; ++i)
+    {
+        result_min = (min_source[i] < result_min) ? min_source[i] : result_min;
+        result_max = (max_source[i] > result_max) ? max_source[i] : result_max;
+    }
+
+    *min_value = result_min;
+    *max_value = result_max;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// [begin, end) indices in the buffer, no wrapping. The samples at the edges are read, then the blocks of the first level
+// at the edges, then the blocks of the second level.
+static void reduce_samples(const ui_plot_data* data, uint32_t begin, uint32_t end, float* min_value, float* max_value)
+{
+    const ui_plot_summary* summary = data->summary;
+    const float* samples = data->samples + begin;
+    uint32_t block_size = (summary != NULL) ? summary->block_size : 0;
+
+    if (summary == NULL || end - begin < block_size * 4)
+    {
+        reduce_min_max(samples, samples, end - begin, min_value, max_value);
+        return;
+    }
+
+    uint32_t num_blocks = data->capacity / block_size;
+    uint32_t block_begin = (begin + block_size - 1) / block_size;
+    uint32_t block_end = end / block_size;
+    reduce_min_max(samples, samples, block_begin * block_size - begin, min_value, max_value);
+    reduce_min_max(data->samples + block_end * block_size, data->samples + block_end * block_size, end - block_end * block_size, min_value, max_value);
+
+    const float* min_values = summary->min_values;
+    const float* max_values = summary->max_values;
+    if (block_end - block_begin >= block_size * 4)
+    {
+        uint32_t coarse_begin = (block_begin + block_size - 1) / block_size;
+        uint32_t coarse_end = block_end / block_size;
+        reduce_min_max(min_values + block_begin, max_values + block_begin, coarse_begin * block_size - block_begin, min_value, max_value);
+        reduce_min_max(min_values + coarse_end * block_size, max_values + coarse_end * block_size, block_end - coarse_end * block_size, min_value, max_value);
+        reduce_min_max(min_values + num_blocks + coarse_begin, max_values + num_blocks + coarse_begin, coarse_end - coarse_begin, min_value, max_value);
+    }
+    else
+        reduce_min_max(min_values + block_begin, max_values + block_begin, block_end - block_begin, min_value, max_value);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// [offset] from the first sample to show, the range can wrap around the end of the ring buffer
+static void reduce_ring(const ui_plot_data* data, uint32_t offset, uint32_t count, float* min_value, float* max_value)
+{
+    *min_value = FLT_MAX;
+    *max_value = -FLT_MAX;
+
+    uint32_t begin = (uint32_t) (((uint64_t) data->first + offset) % data->capacity);
+    uint32_t contiguous = data->capacity - begin;
+    if (count > contiguous)
+    {
+        reduce_samples(data, begin, data->capacity, min_value, max_value);
+        reduce_samples(data, 0, count - contiguous, min_value, max_value);
+    }
+    else
+        reduce_samples(data, begin, begin + count, min_value, max_value);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+uint32_t ui_plot_summary_size(uint32_t capacity, uint32_t block_size)
+{
+    assert(block_size > 1 && capacity % block_size == 0);
+    uint32_t num_blocks = capacity / block_size;
+    return num_blocks + num_blocks / block_size;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// the blocks of the first level are followed by the blocks of the second level, made of block_size blocks
+void ui_plot_summary_update(const ui_plot_summary* summary, const float* samples, uint32_t capacity, uint32_t first, uint32_t count)
+{
+    assert(summary->block_size > 1 && capacity % summary->block_size == 0);
+    assert(first < capacity && count <= capacity);
+
+    // blocks touched by the range, in ring order
+    uint32_t block_size = summary->block_size;
+    uint32_t num_blocks = capacity / block_size;
+    uint32_t num_coarse = num_blocks / block_size;
+    uint32_t first_block = first / block_size;
+    uint32_t num_touched = (uint32_t) (((uint64_t) first % block_size + count + block_size - 1) / block_size);
+    num_touched = (num_touched < num_blocks) ? num_touched : num_blocks;
+
+    for(uint32_t i=0; i<num_touched; ++i)
+    {
+        uint32_t block = (first_block + i) % num_blocks;
+        const float* block_samples = samples + block * block_size;
+        summary->min_values[block] = FLT_MAX;
+        summary->max_values[block] = -FLT_MAX;
+        reduce_min_max(block_samples, block_samples, block_size, &summary->min_values[block], &summary->max_values[block]);
+    }
+
+    // second level, from the blocks
+    uint32_t last_coarse = UINT32_MAX;
+    for(uint32_t i=0; i<num_touched; ++i)
+    {
+        uint32_t coarse = ((first_block + i) % num_blocks) / block_size;
+        if (coarse >= num_coarse || coarse == last_coarse)
+            continue;
+
+        last_coarse = coarse;
+        const float* min_values = summary->min_values + coarse * block_size;
+        const float* max_values = summary->max_values + coarse * block_size;
+        summary->min_values[num_blocks + coarse] = FLT_MAX;
+        summary->max_values[num_blocks + coarse] = -FLT_MAX;
+        reduce_min_max(min_values, max_values, block_size, &summary->min_values[num_blocks + coarse], &summary->max_values[num_blocks + coarse]);
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_plot(ui_context* ctx, const char* label, const ui_plot_data* data, float min_value, float max_value, float height)
+{
+    assert(data->count <= data->capacity && (data->count == 0 || data->first < data->capacity));
+
+    ui_rect rect;
+    if (!begin_chart(ctx, height, &rect))
+        return;
+
+    uint32_t num_columns = (rect.width > 1.f) ? (uint32_t) rect.width : 1;
+    float bottom = rect.y + rect.height;
+    float scale = (max_value > min_value) ? rect.height / (max_value - min_value) : 0.f;
+    uint32_t count = data->count;
+
+    if (count > 0 && count <= num_columns)
+    {
+        // fewer samples than pixels : segments between the samples
+        float step = (count > 1) ? rect.width / (float) (count - 1) : 0.f;
+        float previous_y = 0.f;
+        for(uint32_t i=0; i<count; ++i)
+        {
+            float value = data->samples[((uint64_t) data->first + i) % data->capacity];
+            float y = bottom - clamp_float(0.f, rect.height, (value - min_value) * scale);
+            if (count == 1)
+                render_box(ctx, rect.x, y - .5f, rect.width, 1.f, 0.f, ctx->colors.accent);
+            else if (i > 0)
+                render_line(ctx, rect.x + step * (float) (i - 1), previous_y, rect.x + step * (float) i, y, 1.f, ctx->colors.accent);
+            previous_y = y;
+        }
+    }
+    else if (count > 0)
+    {
+        // one vertical span per column, joined to the span of the previous column
+        float previous_top = 0.f, previous_bottom = 0.f;
+        for(uint32_t column=0; column<num_columns; ++column)
+        {
+            uint32_t begin = (uint32_t) ((uint64_t) count * column / num_columns);
+            uint32_t end = (uint32_t) ((uint64_t) count * (column + 1) / num_columns);
+
+            float column_min, column_max;
+            reduce_ring(data, begin, end - begin, &column_min, &column_max);
+
+            float top = bottom - clamp_float(0.f, rect.height, (column_max - min_value) * scale);
+            float span_bottom = bottom - clamp_float(0.f, rect.height, (column_min - min_value) * scale);
+            if (column > 0)
             {
-                ctx->animation = (ui_animation)
-                {
-                    .value_key0 = ctx->layout.x + seg_rect.width * (*selected),
-                    .value_key1 = ctx->layout.x + seg_rect.width * i,
-                    .widget = selected
-                };
+                top = fminf(top, previous_bottom);
+                span_bottom = fmaxf(span_bottom, previous_top);
+            }
+            previous_top = top;
+            previous_bottom = span_bottom;
 
-                *selected = i;
+            render_box(ctx, rect.x + (float) column, top, 1.f, fmaxf(span_bottom - top, 1.f), 0.f, ctx->colors.accent);
+        }
+    }
+
+    end_chart(ctx, &rect, label);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_histogram_bin(const float* values, uint32_t count, float min_value, float max_value, uint32_t* bins, uint32_t num_bins)
+{
+    assert(num_bins > 0 && max_value > min_value);
+
+    float scale = (float) num_bins / (max_value - min_value);
+    int32_t indices[QUANTIZE_CHUNK];
+    for(uint32_t i=0; i<count; i += QUANTIZE_CHUNK)
+    {
+        uint32_t chunk = (count - i < QUANTIZE_CHUNK) ? count - i : QUANTIZE_CHUNK;
+        quantize_values(values + i, chunk, min_value, scale, 0.f, (float) (num_bins - 1), indices);
+        for(uint32_t j=0; j<chunk; ++j)
+            bins[indices[j]]++;
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// neighbor bins with the same count are one bar
+void ui_histogram(ui_context* ctx, const char* label, const uint32_t* bins, uint32_t num_bins, float height)
+{
+    ui_rect rect;
+    if (!begin_chart(ctx, height, &rect))
+        return;
+
+    uint32_t max_count = 0;
+    for(uint32_t i=0; i<num_bins; ++i)
+        max_count = (bins[i] > max_count) ? bins[i] : max_count;
+
+    if (max_count > 0)
+    {
+        float bar_width = rect.width / (float) num_bins;
+        float scale = rect.height / (float) max_count;
+        float bottom = rect.y + rect.height;
+        for(uint32_t i=0; i<num_bins;)
+        {
+            uint32_t end = i + 1;
+            while (end < num_bins && bins[end] == bins[i])
+                end++;
+
+            if (bins[i] > 0)
+            {
+                float bar_height = (float) bins[i] * scale;
+                render_box(ctx, rect.x + bar_width * (float) i, bottom - bar_height, bar_width * (float) (end - i), bar_height, 0.f, ctx->colors.accent);
             }
-            else if (i != *selected)
+            i = end;
+        }
+    }
+
+    end_chart(ctx, &rect, label);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// The cells are quantized to the steps of the heatmap palette. A run of cells of the same step in a row is one box,
+// the cells of the first step have the color of the background and are not drawn.
+void ui_heatmap(ui_context* ctx, const char* label, const float* cells, uint32_t columns, uint32_t rows,
+                float min_value, float max_value, float height)
+{
+    ui_rect rect;
+    if (!begin_chart(ctx, height, &rect))
+        return;
+
+    const uint32_t* ramp = ctx->palettes[palette_heatmap].colors;
+    float scale = (max_value > min_value) ? (float) PALETTE_STEPS / (max_value - min_value) : 0.f;
+    float cell_width = (columns > 0) ? rect.width / (float) columns : 0.f;
+    float cell_height = (rows > 0) ? rect.height / (float) rows : 0.f;
+    int32_t levels[QUANTIZE_CHUNK];
+
+    for(uint32_t row=0; row<rows; ++row)
+    {
+        const float* row_cells = cells + (size_t) row * columns;
+        float y = rect.y + cell_height * (float) row;
+        uint32_t run_start = 0;
+        int32_t run_level = 0;
+
+        for(uint32_t chunk_start=0; chunk_start<columns; chunk_start += QUANTIZE_CHUNK)
+        {
+            uint32_t chunk = (columns - chunk_start < QUANTIZE_CHUNK) ? columns - chunk_start : QUANTIZE_CHUNK;
+            quantize_values(row_cells + chunk_start, chunk, min_value, scale, .5f, (float) PALETTE_STEPS, levels);
+
+            for(uint32_t i=0; i<chunk; ++i)
             {
-                ctx->renderer.draw_box(seg_rect.x, seg_rect.y + ctx->padding, seg_rect.width, seg_rect.height, 
-                                      ctx->padding, ctx->colors.widget_hover, ctx->renderer.user);
+                if (levels[i] == run_level)
+                    continue;
+
+                uint32_t column = chunk_start + i;
+                if (run_level > 0)
+                    render_box(ctx, rect.x + cell_width * (float) run_start, y, cell_width * (float) (column - run_start), cell_height, 0.f, ramp[run_level]);
+
+                run_start = column;
+                run_level = levels[i];
             }
         }
 
-        draw_align_text(ctx, &seg_rect, entries[i], ctx->colors.text, align_center);
+        if (run_level > 0)
+            render_box(ctx, rect.x + cell_width * (float) run_start, y, cell_width * (float) (columns - run_start), cell_height, 0.f, ramp[run_level]);
+    }
 
-        if (i>0) // separator
-            ctx->renderer.draw_box(seg_rect.x-.5f, seg_rect.y+ctx->padding*2.f, 1.f, seg_rect.height-2.f*ctx->padding,
-                                   0, ctx->colors.separator, ctx->renderer.user);
+    end_chart(ctx, &rect, label);
+}
 
-        seg_rect.x += seg_rect.width;
+//-----------------------------------------------------------------------------------------------------------------------------
+// Table : the rows are shown through a permutation kept by the caller. It is sorted when the sort changes, the rows
+// added later are sorted apart and merged, a changed row is moved with a binary search. The cells are drawn column by column, one clip rect
+// per column.
+//-----------------------------------------------------------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// ties are broken by the row index, the order does not depend on the history of the sort
+static inline bool table_less(const ui_table_data* table, uint32_t row_a, uint32_t row_b)
+{
+    int result = table->compare_rows(row_a, row_b, (uint32_t) table->sort_column, table->user);
+    if (table->descending)
+        result = -result;
+    return (result != 0) ? (result < 0) : (row_a < row_b);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void table_sift_down(const ui_table_data* table, uint32_t* order, uint32_t root, uint32_t count)
+{
+    for(;;)
+    {
+        uint32_t child = root * 2 + 1;
+        if (child >= count)
+            return;
+
+        if (child + 1 < count && table_less(table, order[child], order[child + 1]))
+            child++;
+
+        if (!table_less(table, order[root], order[child]))
+            return;
+
+        uint32_t tmp = order[root];
+        order[root] = order[child];
+        order[child] = tmp;
+        root = child;
     }
-    ui_newline(ctx);
 }
 
+//-----------------------------------------------------------------------------------------------------------------------------
+// heapsort, in place
+static void table_sort(const ui_table_data* table, uint32_t* order, uint32_t count)
+{
+    for(uint32_t i=count/2; i-- > 0;)
+        table_sift_down(table, order, i, count);
+
+    for(uint32_t end=count; end-- > 1;)
+    {
+        uint32_t tmp = order[0];
+        order[0] = order[end];
+        order[end] = tmp;
+        table_sift_down(table, order, 0, end);
+    }
+}
 
 //-----------------------------------------------------------------------------------------------------------------------------
-void ui_slider(ui_context* ctx, const char* label, float min_value, float max_value, float step, float* value, const char* fmt)
+// the rows [first_row, first_row + count) are sorted apart then merged from the end with the first_row sorted entries
+static void table_merge(const ui_table_data* table, uint32_t first_row, uint32_t count)
 {
-    assert(max_value>min_value);
+    uint32_t batch[TABLE_MERGE_CHUNK];
+    assert(count <= TABLE_MERGE_CHUNK);
 
-    // always clamp in case the user change the value
-    *value = clamp_float(min_value, max_value, *value);
+    for(uint32_t i=0; i<count; ++i)
+        batch[i] = first_row + i;
+    table_sort(table, batch, count);
 
-    // first row is just label + value
-    snprintf(ctx->string_buffer, STRING_BUFFER_SIZE, fmt, *value);
-    draw_align_text(ctx, &ctx->layout, label, ctx->colors.text, align_left);
-    draw_align_text(ctx, &ctx->layout, ctx->string_buffer, ctx->colors.text, align_right);
-    ui_newline(ctx);
+    // the place of each row is found with a binary search, the entries after it are moved at once
+    uint32_t* order = table->order;
+    uint32_t read = first_row, write = first_row + count;
+    while (count > 0)
+    {
+        uint32_t row = batch[--count];
+        uint32_t first = 0, last = read;
+        while (first < last)
+        {
+            uint32_t middle = first + (last - first) / 2;
+            if (table_less(table, order[middle], row))
+                first = middle + 1;
+            else
+                last = middle;
+        }
 
-    float center_y = ctx->layout.y + .5f * ctx->layout.height;
+        write -= read - first;
+        memmove(order + write, order + first, (read - first) * sizeof(uint32_t));
+        read = first;
+        order[--write] = row;
+    }
+}
 
-    // track
-    ui_rect track_rect = 
-    { 
-        .x = ctx->layout.x + .1f * ctx->layout.width,
-        .y = center_y - ctx->padding*.5f,
-        .width = .8f * ctx->layout.width,
-        .height = ctx->padding
-    };
+//-----------------------------------------------------------------------------------------------------------------------------
+// inserts [row] in the first [count] sorted entries of the order
+static void table_insert(const ui_table_data* table, uint32_t row, uint32_t count)
+{
+    uint32_t* order = table->order;
+    uint32_t first = 0, last = count;
+    while (first < last)
+    {
+        uint32_t middle = first + (last - first) / 2;
+        if (table_less(table, order[middle], row))
+            first = middle + 1;
+        else
+            last = middle;
+    }
 
-    // thumb geometry
-    float norm_value = (*value - min_value) / (max_value - min_value);
-    float thumb_x = norm_value * track_rect.width + track_rect.x;
-    float thumb_size = ctx->font_height - 4.f;
-    float half_size = thumb_size * .5f;
+    memmove(order + first + 1, order + first, (count - first) * sizeof(uint32_t));
+    order[first] = row;
+}
 
-    ui_rect thumb_rect = 
+//-----------------------------------------------------------------------------------------------------------------------------
+static void table_update_order(ui_table_data* table)
+{
+    bool sorted = table->sort_column >= 0 && table->compare_rows != NULL;
+    if (table->num_sorted > table->num_rows)
+        table->num_sorted = 0;
+
+    uint32_t new_rows = table->num_rows - table->num_sorted;
+    if (new_rows == 0)
+        return;
+
+    if (!sorted)
     {
-        .x = thumb_x - half_size,
-        .y = center_y - half_size,
-        .width = thumb_size,
-        .height = thumb_size
-    };
+        for(uint32_t i=table->num_sorted; i<table->num_rows; ++i)
+            table->order[i] = i;
+    }
+    else if (table->num_sorted == 0 || new_rows > table->num_sorted / 8)
+    {
+        for(uint32_t i=0; i<table->num_rows; ++i)
+            table->order[i] = i;
+        table_sort(table, table->order, table->num_rows);
+    }
+    else
+    {
+        for(uint32_t row=table->num_sorted; row<table->num_rows; row += TABLE_MERGE_CHUNK)
+            table_merge(table, row, (table->num_rows - row < TABLE_MERGE_CHUNK) ? table->num_rows - row : TABLE_MERGE_CHUNK);
+    }
+    table->num_sorted = table->num_rows;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_table_row_changed(ui_table_data* table, uint32_t row)
+{
+    if (table->sort_column < 0 || table->compare_rows == NULL || row >= table->num_sorted)
+        return;
+
+    uint32_t* order = table->order;
+    uint32_t position = 0;
+    while (order[position] != row)
+        position++;
+
+    memmove(order + position, order + position + 1, (table->num_sorted - position - 1) * sizeof(uint32_t));
+    table_insert(table, row, table->num_sorted - 1);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_table(ui_context* ctx, ui_table_data* table)
+{
+    assert(ctx->current_window != NULL);
+    assert(table->num_columns > 0 && table->cell_text != NULL);
+
+    ctx->widget_key = NULL;
+
+    float row_height = ctx->row_height;
+    float header_y = ctx->layout.y;
+    float body_y = header_y + row_height;
+    float min_width = ctx->padding * 4.f;
+    bool clicked = ctx->mouse_button == button_pressed && in_rect(&ctx->clip, ctx->mouse_pos);
+
+    // header : a click sorts by the column or reverses the sort, the right edge of a column resizes it
+    ctx->layout.height = row_height;
+    bool header_visible = !cull_widget(ctx, row_height);
+    float column_x = ctx->layout.x;
+    for(uint32_t c=0; c<table->num_columns; ++c)
+    {
+        ui_table_column* column = &table->columns[c];
+        ui_rect handle = {.x = column_x + column->width - ctx->padding, .y = header_y, .width = ctx->padding * 2.f, .height = row_height};
+        ui_rect header = {.x = column_x, .y = header_y, .width = column->width, .height = row_height};
+
+        if (clicked && in_rect(&handle, ctx->mouse_pos))
+        {
+            ctx->dragging_object = &column->width;
+            ctx->dragging_offset.x = ctx->mouse_pos.x - column->width;
+            clicked = false;
+        }
+        else if (clicked && in_rect(&header, ctx->mouse_pos) && table->compare_rows != NULL)
+        {
+            table->descending = (table->sort_column == (int32_t) c) ? !table->descending : false;
+            table->sort_column = (int32_t) c;
+            table->num_sorted = 0;
+            clicked = false;
+        }
 
-    const bool track_hovered = in_rect(&track_rect, ctx->mouse_pos);
-    const bool thumb_hovered = in_rect(&thumb_rect, ctx->mouse_pos);
+        if (ctx->mouse_down && ctx->dragging_object == &column->width)
+            column->width = fmaxf(min_width, ctx->mouse_pos.x - ctx->dragging_offset.x);
 
-    // track change color on mouse-over
-    uint32_t track_color = (track_hovered || (ctx->dragging_object == value)) ? ctx->colors.widget_hover : ctx->colors.widget_bg;
-    ctx->renderer.draw_box(track_rect.x, track_rect.y, track_rect.width, track_rect.height,
-                           track_rect.height*.5f, track_color, ctx->renderer.user);
+        column_x += column->width;
+    }
+    float table_width = column_x - ctx->layout.x;
 
-    // thumb mouse-over and dragging
-    if (thumb_hovered)
+    table_update_order(table);
+
+    // visible rows
+    float first_row = floorf((ctx->clip.y - body_y) / row_height);
+    float last_row = ceilf((ctx->clip.y + ctx->clip.height - body_y) / row_height);
+    uint32_t row_begin = (uint32_t) clamp_float(0.f, (float) table->num_rows, first_row);
+    uint32_t row_end = (uint32_t) clamp_float(0.f, (float) table->num_rows, last_row);
+
+    if (header_visible)
     {
-        expand_rect(&thumb_rect, 2.f);
-        if (ctx->mouse_button == button_pressed)
+        render_box(ctx, ctx->layout.x, header_y, table_width, row_height, 0.f, ctx->colors.widget_bg);
+        column_x = ctx->layout.x;
+        for(uint32_t c=0; c<table->num_columns; ++c)
         {
-            ctx->dragging_object = value;
-            ctx->dragging_offset.x = ctx->mouse_pos.x - thumb_x;
+            column_x += table->columns[c].width;
+            render_box(ctx, column_x - 1.f, header_y, 1.f, row_height, 0.f, ctx->colors.separator);
+
+            // sort indicator : at the bottom of the header when ascending, at the top when descending
+            if (table->sort_column == (int32_t) c)
+            {
+                float indicator_y = table->descending ? header_y : header_y + row_height - 2.f;
+                render_box(ctx, column_x - table->columns[c].width, indicator_y, table->columns[c].width - 1.f, 2.f, 0.f, ctx->colors.accent);
+            }
         }
     }
-    else if (track_hovered && ctx->mouse_button == button_pressed)
+
+    dirty_begin_segment(ctx, ctx->current_window->id, ++ctx->dirty_index);
+    for(uint32_t r=row_begin; r<row_end; ++r)
+        if (r & 1)
+            render_box(ctx, ctx->layout.x, body_y + row_height * (float) r, table_width, row_height, 0.f, ctx->colors.value_bg);
+
+    // cells
+    float clip_min_y = fmaxf(ctx->clip.y, 0.f);
+    float clip_max_y = ctx->clip.y + ctx->clip.height;
+    bool clipped = false;
+    column_x = ctx->layout.x;
+    for(uint32_t c=0; c<table->num_columns; ++c)
     {
-        // click on track make the thumb move
-        ctx->animation = (ui_animation)
+        float cell_x = column_x + ctx->padding * .5f;
+        float clip_min_x = fmaxf(fmaxf(column_x, ctx->clip.x), 0.f);
+        float clip_max_x = fminf(column_x + table->columns[c].width - ctx->padding * .5f, ctx->clip.x + ctx->clip.width);
+        column_x += table->columns[c].width;
+        if (clip_max_x <= clip_min_x || clip_max_y <= clip_min_y)
+            continue;
+
+        dirty_begin_segment(ctx, ctx->current_window->id, ++ctx->dirty_index);
+        clipped = true;
+        render_clip_rect(ctx, (uint16_t) clip_min_x, (uint16_t) clip_min_y, (uint16_t) (clip_max_x + .5f), (uint16_t) (clip_max_y + .5f));
+
+        if (header_visible)
+            render_text(ctx, cell_x, header_y, table->columns[c].name,
+                        (table->sort_column == (int32_t) c) ? ctx->colors.accent : ctx->colors.text);
+
+        for(uint32_t r=row_begin; r<row_end; ++r)
         {
-            .widget = value,
-            .value_key0 = thumb_x,
-            .value_key1 = ctx->mouse_pos.x
-        };
-
-        if (ctx->dragging_object == value)
-            ctx->dragging_object = NULL;
+            const char* text = table->cell_text(table->order[r], c, table->user);
+            if (text != NULL)
+                render_text(ctx, cell_x, body_y + row_height * (float) r, text, ctx->colors.text);
+        }
     }
 
-    // click-on-track update
-    if (ctx->animation.widget == value)
-        thumb_x = lerp_float(ctx->animation.value_key0, ctx->animation.value_key1, ctx->animation.t);
+    // back to the clip rect of the window
+    if (clipped)
+        render_clip_rect(ctx, (uint16_t) ctx->clip.x, (uint16_t) ctx->clip.y, (uint16_t) (ctx->clip.x + ctx->clip.width),
+                         (uint16_t) (ctx->clip.y + ctx->clip.height));
 
-    // drag update
-    if (ctx->mouse_down && ctx->dragging_object == value)
-        thumb_x = ctx->mouse_pos.x - ctx->dragging_offset.x;
+    // layout after the last row
+    ctx->layout.y = body_y + row_height * ((float) table->num_rows - 1.f);
+    ctx->layout.height = row_height;
+    ui_newline(ctx);
+}
 
-    thumb_x = clamp_float(track_rect.x, track_rect.x + track_rect.width, thumb_x);
-    norm_value = (thumb_x - track_rect.x) / track_rect.width;
-    *value = norm_value * (max_value - min_value) + min_value;
-    *value = (step>0.f) ? roundf(*value / step) * step : *value;
+//-----------------------------------------------------------------------------------------------------------------------------
+// Log : the new bytes are scanned with memchr, a line starts after each '\n'. The last start is at the end of the
+// indexed text when it ends with '\n', this empty line is not shown.
+//-----------------------------------------------------------------------------------------------------------------------------
 
-    ctx->renderer.draw_box(thumb_rect.x, thumb_rect.y, thumb_rect.width, thumb_rect.height, half_size,
-                           ctx->colors.accent, ctx->renderer.user);
+//-----------------------------------------------------------------------------------------------------------------------------
+static void log_add_line(ui_log_data* log, size_t start)
+{
+    if (log->num_lines == log->max_lines)
+    {
+        uint32_t dropped = log->max_lines / 2;
+        log->num_lines -= dropped;
+        memmove(log->line_starts, log->line_starts + dropped, log->num_lines * sizeof(size_t));
+        log->first_line = (log->first_line > dropped) ? log->first_line - dropped : 0;
+    }
+    log->line_starts[log->num_lines++] = start;
+}
 
-    ui_newline(ctx);
+//-----------------------------------------------------------------------------------------------------------------------------
+static void log_index(ui_log_data* log)
+{
+    if (log->num_lines == 0 || log->indexed_length > log->length)
+    {
+        log->num_lines = 0;
+        log->indexed_length = 0;
+        log->first_line = 0;
+        log_add_line(log, 0);
+    }
+
+    size_t end = log->length;
+    if (end - log->indexed_length > LOG_INDEX_BUDGET)
+        end = log->indexed_length + LOG_INDEX_BUDGET;
+
+    const char* text = log->text;
+    for(const char* p = text + log->indexed_length; p < text + end; )
+    {
+        const char* eol = (const char*) memchr(p, '\n', (size_t) (text + end - p));
+        if (eol == NULL)
+            break;
+
+        p = eol + 1;
+        log_add_line(log, (size_t) (p - text));
+    }
+    log->indexed_length = end;
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-bool ui_button(ui_context* ctx, const char* label, enum ui_text_alignment alignment)
+void ui_log(ui_context* ctx, ui_log_data* log, float height)
 {
-    bool clicked = false;
-    float text_width = ctx->renderer.text_width(label, ctx->renderer.user);
+    assert(log->line_starts != NULL && log->max_lines >= 2);
+
+    log_index(log);
+
+    ui_rect area;
+    if (!begin_chart(ctx, height, &area))
+        return;
+
+    uint32_t num_lines = log->num_lines - (log->line_starts[log->num_lines - 1] == log->indexed_length);
+    float line_height = ctx->font_height + ctx->padding * .25f;
+    uint32_t page_lines = (uint32_t) fmaxf(area.height / line_height, 1.f);
+    uint32_t max_first = (num_lines > page_lines) ? num_lines - page_lines : 0;
+
+    // scrollbar on the right of the area, the lines take the rest
+    ui_rect track_rect = {area.x + area.width - ctx->padding * .5f, area.y, ctx->padding * .5f, area.height};
+    float thumb_height = fminf(fmaxf(track_rect.height * (float) page_lines / (float) (num_lines + 1), ctx->row_height * .5f), track_rect.height);
+    float thumb_range = track_rect.height - thumb_height;
+    ui_rect thumb_rect = {track_rect.x, track_rect.y, track_rect.width, thumb_height};
+    if (max_first > 0)
+        thumb_rect.y += thumb_range * fminf((float) log->first_line / (float) max_first, 1.f);
+
+    ui_rect hit_rect = thumb_rect;
+    expand_rect(&hit_rect, ctx->padding * .25f);
+    bool hovered = in_rect(&area, ctx->mouse_pos) && in_rect(&ctx->clip, ctx->mouse_pos);
+    if (ctx->mouse_button == button_pressed && max_first > 0 && in_rect(&hit_rect, ctx->mouse_pos) && in_rect(&ctx->clip, ctx->mouse_pos))
+    {
+        ctx->dragging_object = log;
+        ctx->dragging_offset.y = ctx->mouse_pos.y - thumb_rect.y;
+    }
 
-    ui_rect button_rect = {.y = ctx->layout.y, .height = ctx->row_height, .width = text_width + 2.f * ctx->padding};
+    // the user scrolls : following the tail only from the bottom
+    bool dragging = ctx->dragging_object == log;
+    bool scrolled = false;
+    float first_line = (float) log->first_line;
+    if (ctx->mouse_down && dragging && thumb_range > 0.f)
+    {
+        first_line = clamp_float(0.f, 1.f, (ctx->mouse_pos.y - ctx->dragging_offset.y - track_rect.y) / thumb_range) * (float) max_first + .5f;
+        scrolled = true;
+    }
+    else if (hovered && ctx->mouse_wheel != 0.f)
+    {
+        first_line -= ctx->mouse_wheel * SCROLL_ROWS_PER_WHEEL_STEP;
+        ctx->mouse_wheel = 0.f;
+        scrolled = true;
+    }
 
-    switch(alignment)
+    if (scrolled)
     {
-    case align_left: button_rect.x = ctx->layout.x; break;
-    case align_center: button_rect.x = ctx->layout.x + ctx->layout.width * .5f - button_rect.width * .5f; break;
-    default: button_rect.x = ctx->layout.x + ctx->layout.width - button_rect.width; break;
+        log->first_line = (uint32_t) clamp_float(0.f, (float) max_first, first_line);
+        log->follow_tail = log->first_line == max_first;
     }
-    
-    ui_vec2 text_pos = {button_rect.x + ctx->padding, button_rect.y + button_rect.height * .5f - ctx->font_height + ctx->padding};
-    uint32_t button_color = ctx->colors.widget_bg;
-    if (ctx->animation.widget == label)
+    else
+        log->first_line = log->follow_tail ? max_first : ((log->first_line < max_first) ? log->first_line : max_first);
+
+    if (max_first > 0)
     {
-        button_color = lerp_color(ctx->colors.accent, ctx->colors.window_bg, ease_in_expo(ctx->animation.t));
-        expand_rect(&button_rect, -ease_impulse(ctx->animation.t) * 2.f);
+        thumb_rect.y = track_rect.y + thumb_range * (float) log->first_line / (float) max_first;
+        render_box(ctx, track_rect.x, track_rect.y, track_rect.width, track_rect.height, track_rect.width * .5f, ctx->colors.value_bg);
+        render_box(ctx, thumb_rect.x, thumb_rect.y, thumb_rect.width, thumb_rect.height, thumb_rect.width * .5f,
+                   (dragging || in_rect(&hit_rect, ctx->mouse_pos)) ? ctx->colors.accent : ctx->colors.widget_active);
     }
-    else if (in_rect(&button_rect, ctx->mouse_pos))
+
+    // lines intersecting the area and the clip rect of the window
+    float clip_min_x = fmaxf(fmaxf(area.x, ctx->clip.x), 0.f);
+    float clip_max_x = fminf(track_rect.x - ctx->padding * .5f, ctx->clip.x + ctx->clip.width);
+    float clip_min_y = fmaxf(fmaxf(area.y, ctx->clip.y), 0.f);
+    float clip_max_y = fminf(area.y + area.height, ctx->clip.y + ctx->clip.height);
+    if (clip_max_x > clip_min_x && clip_max_y > clip_min_y)
     {
-        if (ctx->mouse_button == button_pressed)
-        {
-            clicked = true;
-            if (ctx->animation.widget != label)
-                ctx->animation = (ui_animation) {.widget = (void*) label};
-        }
-        else
+        dirty_begin_segment(ctx, ctx->current_window->id, ++ctx->dirty_index);
+        render_clip_rect(ctx, (uint16_t) clip_min_x, (uint16_t) clip_min_y, (uint16_t) (clip_max_x + .5f), (uint16_t) (clip_max_y + .5f));
+
+        uint32_t line_begin = log->first_line + (uint32_t) floorf((clip_min_y - area.y) / line_height);
+        uint32_t line_end = log->first_line + (uint32_t) ceilf((clip_max_y - area.y) / line_height);
+        line_end = (line_end < num_lines) ? line_end : num_lines;
+
+        const char* text = log->text;
+        for(uint32_t i=line_begin; i<line_end; ++i)
         {
-            if (ctx->animation.widget == label && ctx->mouse_down)
-                button_color = ctx->colors.accent;
-            else if (ctx->hover.widget == label)
-                button_color = lerp_color(ctx->colors.widget_bg, ctx->colors.widget_hover, ctx->hover.t);
-            else
-                ctx->hover = (ui_hover) {.widget = (void*) label};
+            size_t start = log->line_starts[i];
+            size_t end = (i + 1 < log->num_lines) ? log->line_starts[i + 1] - 1 : log->indexed_length;
+            if (end > start && text[end - 1] == '\r')
+                end--;
+
+            size_t length = (end - start < LOG_MAX_COLUMNS) ? end - start : LOG_MAX_COLUMNS;
+            if (length > 0)
+                render_text_length(ctx, area.x, area.y + line_height * (float) (i - log->first_line), text + start, length, ctx->colors.text);
         }
+
+        render_clip_rect(ctx, (uint16_t) ctx->clip.x, (uint16_t) ctx->clip.y, (uint16_t) (ctx->clip.x + ctx->clip.width),
+                         (uint16_t) (ctx->clip.y + ctx->clip.height));
     }
-    else if (ctx->hover.widget == label)
-        ctx->hover.widget = NULL;
 
-    // border
-    ctx->renderer.draw_box(button_rect.x, button_rect.y, button_rect.width, button_rect.height, 
-                           ctx->corner, ctx->colors.separator, ctx->renderer.user);
+    end_chart(ctx, &area, NULL);
+}
 
-    expand_rect(&button_rect, -1.f);
+//-----------------------------------------------------------------------------------------------------------------------------
+const ui_rect* ui_get_layout(const ui_context* ctx)
+{
+    return &ctx->layout;
+}
 
-    ctx->renderer.draw_box(button_rect.x, button_rect.y, button_rect.width, button_rect.height, 
-                           ctx->corner, button_color, ctx->renderer.user);
+//-----------------------------------------------------------------------------------------------------------------------------
+// [body] clip rect of the window content
+static void window_scrollbar(ui_context* ctx, ui_window* w, ui_rect body)
+{
+    // the window can be smaller than its content : title + two rows
+    w->content_height = ctx->layout.y + w->scroll - ctx->content_y;
+    w->min_height = ctx->row_height * 3.f + ctx->padding * 3.f;
+
+    float max_scroll = w->content_height - body.height;
+    if (max_scroll <= 0.f)
+        return;
+
+    // scrollbar in the right margin of the window
+    ui_rect track_rect = {body.x + body.width + ctx->padding * .25f, body.y, ctx->padding * .5f, body.height};
+    float thumb_height = fmaxf(track_rect.height * body.height / w->content_height, ctx->row_height * .5f);
+    float thumb_range = track_rect.height - thumb_height;
+    ui_rect thumb_rect = {track_rect.x, track_rect.y + thumb_range * w->scroll / max_scroll, track_rect.width, thumb_height};
+
+    ui_rect hit_rect = thumb_rect;
+    expand_rect(&hit_rect, ctx->padding * .25f);
+    if (ctx->mouse_button == button_pressed && in_rect(&hit_rect, ctx->mouse_pos))
+    {
+        ctx->dragging_object = &w->scroll;
+        ctx->dragging_offset.y = ctx->mouse_pos.y - thumb_rect.y;
+    }
 
-    ctx->renderer.draw_text(text_pos.x, text_pos.y, label, ctx->colors.text, ctx->renderer.user);
+    bool dragging = ctx->dragging_object == &w->scroll;
+    if (ctx->mouse_down && dragging)
+    {
+        float t = clamp_float(0.f, 1.f, (ctx->mouse_pos.y - ctx->dragging_offset.y - track_rect.y) / thumb_range);
+        w->scroll = t * max_scroll;
+        thumb_rect.y = track_rect.y + thumb_range * t;
+    }
 
-    return clicked;
+    render_box(ctx, track_rect.x, track_rect.y, track_rect.width, track_rect.height, track_rect.width * .5f, ctx->colors.widget_bg);
+    render_box(ctx, thumb_rect.x, thumb_rect.y, thumb_rect.width, thumb_rect.height, thumb_rect.width * .5f,
+               (dragging || in_rect(&hit_rect, ctx->mouse_pos)) ? ctx->colors.accent : ctx->colors.widget_active);
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-void ui_knob(ui_context* ctx, const char* label, float min_value, float max_value, float default_value, float* value)
+void ui_end_window(ui_context* ctx)
 {
-    // knob needs more space
-    ctx->layout.height = ctx->row_height * 2.f;
+    assert(ctx->current_window != NULL);
 
-    float text_width = ctx->renderer.text_width(label, ctx->renderer.user);
-    float width = ctx->layout.height * 2.f;
-    float cx = ctx->layout.x + width * .5f;
-    float cy = ctx->layout.y + ctx->layout.height * .25f + ctx->padding;
-    float radius = ctx->layout.height * .25f;
+#if UI_STATS
+    if (ctx->get_time != NULL && ctx->stats.num_windows > 0)
+        ctx->window_stats[ctx->stats.num_windows - 1].build_time = (float) (ctx->get_time() - ctx->window_start_time);
+#endif
 
-    ui_rect knob_rect = {.x = cx - radius, .y = cy - radius, .width = radius * 2.f, .height = radius * 2.f};
-    bool hovered = in_rect(&knob_rect, ctx->mouse_pos);
+    ui_window* w = ctx->current_window;
+    ui_rect body = ctx->clip;
 
-    if (hovered && ctx->mouse_button == button_pressed)
+    dirty_begin_segment(ctx, w->id, ++ctx->dirty_index);
+    ctx->current_window = NULL;
+    ctx->clip = (ui_rect) {0.f, 0.f, (float)UINT16_MAX, (float)UINT16_MAX};
+    render_clip_rect(ctx, 0, 0, UINT16_MAX, UINT16_MAX);
+
+    if (w->options&window_scrollable)
+        window_scrollbar(ctx, w, body);
+    else
+        w->min_height = ctx->layout.y - w->pos.y + ctx->row_height * 2.f;
+
+    // range of commands of the window, see ui_merge_commands()
+    w->command_count = ctx->num_commands - w->command_offset;
+    ctx->occluded = false;
+
+    // primitives outside of the windows
+    dirty_begin_segment(ctx, 0, ++ctx->dirty_index);
+
+    if (ctx->mouse_hidden)
     {
-        ctx->dragging_object = value;
-        ctx->dragging_offset.y = ctx->mouse_pos.y;
+        ctx->mouse_pos = ctx->hidden_mouse.pos;
+        ctx->mouse_button = ctx->hidden_mouse.button;
+        ctx->mouse_down = ctx->hidden_mouse.down;
+        ctx->mouse_doubleclick = ctx->hidden_mouse.doubleclick;
+        ctx->mouse_wheel = ctx->hidden_mouse.wheel;
+        ctx->mouse_hidden = false;
     }
+}
 
-    bool active = ctx->dragging_object == value;
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline void list_set_row(ui_context* ctx, uint32_t index)
+{
+    ui_newline(ctx);
+    ctx->layout.y = ctx->list_y + ctx->list_item_height * (float) index;
+}
 
-    // default value and double click managment
-    if (hovered && ctx->mouse_doubleclick)
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_list_begin(ui_context* ctx, uint32_t num_items, float item_height)
+{
+    assert(ctx->current_window != NULL);
+
+    ctx->list_num_items = num_items;
+    ctx->list_item_height = (item_height > 0.f) ? item_height : ctx->row_height;
+    ctx->list_y = ctx->layout.y;
+
+    // range of items intersecting the clip rect
+    float first = floorf((ctx->clip.y - ctx->list_y) / ctx->list_item_height);
+    float last = ceilf((ctx->clip.y + ctx->clip.height - ctx->list_y) / ctx->list_item_height);
+    ctx->list_next = (uint32_t) clamp_float(0.f, (float) num_items, first);
+    ctx->list_end = (uint32_t) clamp_float(0.f, (float) num_items, last);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+bool ui_list_next(ui_context* ctx, uint32_t* index)
+{
+    assert(ctx->current_window != NULL);
+
+    if (ctx->list_next >= ctx->list_end)
     {
-        ctx->animation = (ui_animation)
-        {
-            .value_key0 = *value,
-            .value_key1 = default_value,
-            .widget = value
-        };
+        // skip the hidden items at the end of the list
+        list_set_row(ctx, ctx->list_num_items);
+        ctx->list_next = ctx->list_end = 0;
+        return false;
     }
 
-    if (ctx->animation.widget == value)
+    list_set_row(ctx, ctx->list_next);
+    *index = ctx->list_next++;
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// reverses the commands in [first, last)
+static void reverse_commands(ui_command* commands, uint32_t first, uint32_t last)
+{
+    for(; first + 1 < last; ++first, --last)
     {
-        *value = lerp_float(ctx->animation.value_key0, ctx->animation.value_key1, ctx->animation.t);
+        ui_command tmp = commands[first];
+        commands[first] = commands[last - 1];
+        commands[last - 1] = tmp;
     }
-    else if (active)
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Deferred mode : sorts the commands of the windows back to front, in place. The blocks of commands are moved with
+// rotations during an insertion sort, nothing moves when the windows are built in z order. Commands outside of
+// the windows stay on top in their order.
+static void sort_windows_commands(ui_context* ctx)
+{
+    ui_command_range ranges[MAX_WINDOWS * 2 + 1];
+    uint32_t num_ranges = 0;
+
+    // windows of the frame in building order
+    for(uint32_t i=0; i<ctx->num_windows; ++i)
     {
-        // if dragging, update the value
-        float dx = ctx->dragging_offset.y - ctx->mouse_pos.y;
-        ctx->dragging_offset.y = ctx->mouse_pos.y;
-        float sens = ctx->font_height * 12.f;
-        float v = *value + dx * (max_value - min_value) / sens;
-        v = clamp_float(min_value, max_value, v);
-        *value = v;
+        ui_window* w = &ctx->windows[i];
+        if (w->last_frame != ctx->frame_index)
+            continue;
+
+        uint32_t j = num_ranges++;
+        for(; j>0 && ranges[j-1].offset > w->command_offset; --j)
+            ranges[j] = ranges[j-1];
+        ranges[j] = (ui_command_range) {.offset = w->command_offset, .count = w->command_count, .z = w->z, .window = w};
     }
 
-    // draw bound dots
-    float min_angle = -4.1887902f;
-    float max_angle = 1.0471975512f;
-    float bound_distance = radius * 1.05f;
-    float bound_radius = radius * .1f;
+    // commands outside of the windows
+    uint32_t num_window_ranges = num_ranges, offset = 0;
+    for(uint32_t i=0; i<=num_window_ranges; ++i)
+    {
+        uint32_t end = (i < num_window_ranges) ? ranges[i].offset : ctx->num_commands;
+        if (end > offset)
+            ranges[num_ranges++] = (ui_command_range) {.offset = offset, .count = end - offset, .z = UINT32_MAX};
+        if (i < num_window_ranges)
+            offset = ranges[i].offset + ranges[i].count;
+    }
 
-    float bx1 = cx + cosf(min_angle) * bound_distance;
-    float by1 = cy + sinf(min_angle) * bound_distance;
-    float bx2 = cx + cosf(max_angle) * bound_distance;
-    float by2 = cy + sinf(max_angle) * bound_distance;
+    // back in offset order, gaps included
+    for(uint32_t i=1; i<num_ranges; ++i)
+    {
+        ui_command_range range = ranges[i];
+        uint32_t j = i;
+        for(; j>0 && ranges[j-1].offset > range.offset; --j)
+            ranges[j] = ranges[j-1];
+        ranges[j] = range;
+    }
 
-    draw_disc(ctx, bx1, by1, bound_radius, ctx->colors.separator);
-    draw_disc(ctx, bx2, by2, bound_radius, ctx->colors.separator);
+    ui_command* commands = (ui_command*) ctx->command_buffer;
+    for(uint32_t i=1; i<num_ranges; ++i)
+    {
+        for(uint32_t j=i; j>0 && ranges[j-1].z > ranges[j].z; --j)
+        {
+            // rotation of the two blocks
+            uint32_t first = ranges[j-1].offset, middle = ranges[j].offset, last = middle + ranges[j].count;
+            reverse_commands(commands, first, middle);
+            reverse_commands(commands, middle, last);
+            reverse_commands(commands, first, last);
+
+            ui_command_range tmp = ranges[j];
+            tmp.offset = first;
+            ranges[j] = ranges[j-1];
+            ranges[j].offset = first + tmp.count;
+            ranges[j-1] = tmp;
+        }
+    }
 
-    // knob rendering
-    float inner_radius = radius * .8f;
-    uint32_t knob_color = ctx->colors.widget_bg;
-    if (active)
-        knob_color = ctx->colors.widget_active;
-    else if (hovered)
-        knob_color = ctx->colors.widget_hover;
+    for(uint32_t i=0; i<num_ranges; ++i)
+        if (ranges[i].window != NULL)
+            ranges[i].window->command_offset = ranges[i].offset;
+}
 
-    draw_disc(ctx, cx, cy, radius, ctx->colors.window_border);
-    draw_disc(ctx, cx, cy, inner_radius, knob_color);
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_end_frame(ui_context* ctx)
+{
+    assert(ctx->current_window == NULL);
 
-    // draw value mark
-    float t = (*value - min_value) / (max_value - min_value);
-    t = clamp_float(0.f, 1.f, t);
+    if (ctx->command_buffer != NULL)
+        sort_windows_commands(ctx);
 
-    float angle = min_angle + t * (max_angle - min_angle);
-    float mark_radius = inner_radius * 0.9f;
-    float mx = cosf(angle);
-    float my = sinf(angle);
-    float line_width = ctx->padding / 8.f;
+    if (ctx->track_dirty_rects)
+        compute_dirty_rects(ctx);
 
-    ctx->renderer.draw_line(cx, cy, cx + mx * mark_radius, cy + my * mark_radius, line_width, ctx->colors.accent, ctx->renderer.user);
-    ctx->renderer.draw_text(cx - text_width * .5f, cy + ctx->font_height, label, ctx->colors.text, ctx->renderer.user);
+    UI_STAT(ctx->stats.culled_widgets = ctx->culled_widgets);
+    UI_STAT(ctx->stats.active_animations = ctx->animations.count);
 
-    ctx->layout.x += width;
-    ctx->layout.width -= width;
+    // evicts the animations of widgets not seen this frame and the finished tweens, the last entry fills the hole
+    ui_animation_pool* pool = &ctx->animations;
+    for(uint32_t i=0; i<pool->count; )
+    {
+        if (pool->last_frame[i] == ctx->frame_index && (pool->kind[i] != animation_tween || pool->t[i] < 1.f))
+        {
+            ++i;
+            continue;
+        }
+
+        uint32_t last = --pool->count;
+        pool->widget[i] = pool->widget[last];
+        pool->kind[i] = pool->kind[last];
+        pool->key0_to_key1[i] = pool->key0_to_key1[last];
+        pool->last_frame[i] = pool->last_frame[last];
+        pool->t[i] = pool->t[last];
+        pool->speed[i] = pool->speed[last];
+        pool->value_key0[i] = pool->value_key0[last];
+        pool->value_key1[i] = pool->value_key1[last];
+        pool->color_key0[i] = pool->color_key0[last];
+        pool->color_key1[i] = pool->color_key1[last];
+    }
+
+    if (ctx->mouse_button == button_released)
+    {
+        ctx->resizing_window = NULL;
+        ctx->dragging_object = NULL;
+    }
+
+    // the widgets react to an input during the frame but some of them are drawn with the state of the last frame,
+    // one more frame is needed. The hover fades kept at the end stay in the pool but do not move.
+    ctx->idle = !ctx->input_received && ctx->dragging_object == NULL && ctx->resizing_window == NULL;
+    for(uint32_t i=0; i<pool->count && ctx->idle; ++i)
+        ctx->idle = pool->t[i] >= 1.f;
+
+    ctx->mouse_button = button_idle;
+    ctx->mouse_wheel = 0.f;
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-const ui_rect* ui_get_layout(const ui_context* ctx)
+const ui_command* ui_get_commands(const ui_context* ctx, uint32_t* num_commands)
 {
-    return &ctx->layout;
+    *num_commands = ctx->num_commands;
+    return (const ui_command*) ctx->command_buffer;
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-void ui_end_window(ui_context* ctx)
+void ui_render_commands(const ui_command* commands, uint32_t num_commands, const ui_renderer_fnc_t* renderer)
 {
-    assert(ctx->current_window != NULL);
-    ctx->current_window->min_height = ctx->layout.y - ctx->current_window->pos.y + ctx->row_height * 2.f;
-    ctx->current_window = NULL;
-    ctx->renderer.set_clip_rect(0, 0, UINT16_MAX, UINT16_MAX, ctx->renderer.user);
+    for(uint32_t i=0; i<num_commands; ++i)
+    {
+        const ui_command* cmd = &commands[i];
+        switch(cmd->type)
+        {
+        case command_box:
+            renderer->draw_box(cmd->data.box.x, cmd->data.box.y, cmd->data.box.width, cmd->data.box.height,
+                               cmd->data.box.radius, cmd->srgb_color, renderer->user);
+            break;
+        case command_text:
+            renderer->draw_text(cmd->data.text.x, cmd->data.text.y, cmd->data.text.text, cmd->srgb_color, renderer->user);
+            break;
+        case command_line:
+            renderer->draw_line(cmd->data.line.x0, cmd->data.line.y0, cmd->data.line.x1, cmd->data.line.y1,
+                                cmd->data.line.width, cmd->srgb_color, renderer->user);
+            break;
+        case command_clip_rect:
+            renderer->set_clip_rect(cmd->data.clip_rect.min_x, cmd->data.clip_rect.min_y,
+                                    cmd->data.clip_rect.max_x, cmd->data.clip_rect.max_y, renderer->user);
+            break;
+        }
+    }
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------
-void ui_end_frame(ui_context* ctx)
+void ui_invalidate_text_cache(ui_context* ctx)
 {
-    assert(ctx->current_window == NULL);
+    memset(ctx->text_cache, 0, sizeof(ctx->text_cache));
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_get_text_cache_stats(const ui_context* ctx, uint32_t* hits, uint32_t* misses)
+{
+    *hits = ctx->text_cache_hits;
+    *misses = ctx->text_cache_misses;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_merge_commands(ui_context* ctx, const ui_context* src)
+{
+    assert(ctx->command_buffer != NULL && src->command_buffer != NULL);
+    assert(ctx->current_window == NULL && src->current_window == NULL);
 
-    if (ctx->animation.t >= 1.f)
+    // windows begun during the last frame of src, back to front (sorted by ui_end_frame)
+    const ui_window* windows[MAX_WINDOWS];
+    uint32_t num_windows = 0;
+    for(uint32_t i=0; i<src->num_windows; ++i)
     {
-        ctx->animation.widget = NULL;
-        ctx->animation.t = 1.f;
+        const ui_window* w = &src->windows[i];
+        if (w->last_frame != src->frame_index)
+            continue;
+
+        uint32_t j = num_windows++;
+        for(; j>0 && windows[j-1]->command_offset > w->command_offset; --j)
+            windows[j] = windows[j-1];
+        windows[j] = w;
     }
 
-    if (ctx->mouse_button == button_released)
+    // each window of src has a window in ctx taking part in its z order, the ids must be unique across the contexts
+    const ui_command* commands = (const ui_command*) src->command_buffer;
+    for(uint32_t i=0; i<num_windows; ++i)
     {
-        ctx->resizing_window = NULL;
-        ctx->dragging_object = NULL;
+        uint32_t slot = find_window_slot(ctx, windows[i]->id);
+        if (ctx->window_table[slot] == 0)
+        {
+            assert(ctx->num_windows < MAX_WINDOWS);
+            ctx->window_table[slot] = (uint16_t) (ctx->num_windows + 1);
+            ctx->windows[ctx->num_windows++] = (ui_window) {.name = windows[i]->name, .id = windows[i]->id, .z = ++ctx->z_counter};
+        }
+
+        ui_window* w = &ctx->windows[ctx->window_table[slot] - 1];
+        assert(w->last_frame != ctx->frame_index);
+        w->pos = windows[i]->pos;
+        w->width = windows[i]->width;
+        w->height = windows[i]->height;
+        w->options = windows[i]->options;
+        w->last_frame = ctx->frame_index;
+        w->command_offset = ctx->num_commands;
+
+        // covered by a window of ctx or merged before
+        ctx->occluded = window_occluded(ctx, w);
+        ctx->dirty_index = 0;
+        dirty_begin_segment(ctx, w->id, 0);
+        if (ctx->track_dirty_rects)
+            dirty_windows_above(ctx, w);
+
+        uint32_t count = ctx->occluded ? 0 : windows[i]->command_count;
+        for(uint32_t j=0; j<count; ++j)
+        {
+            const ui_command* cmd = &commands[windows[i]->command_offset + j];
+            switch(cmd->type)
+            {
+            case command_box:
+                render_box(ctx, cmd->data.box.x, cmd->data.box.y, cmd->data.box.width, cmd->data.box.height,
+                           cmd->data.box.radius, cmd->srgb_color);
+                break;
+            case command_text:
+                UI_STAT(ctx->stats.draw_text++);
+                if (ctx->track_dirty_rects)
+                    dirty_text(ctx, cmd->data.text.x, cmd->data.text.y, cmd->data.text.text, cmd->data.text.length, cmd->srgb_color);
+                push_text(ctx, cmd->data.text.x, cmd->data.text.y, cmd->data.text.text, cmd->data.text.length, cmd->srgb_color);
+                break;
+            case command_line:
+                render_line(ctx, cmd->data.line.x0, cmd->data.line.y0, cmd->data.line.x1, cmd->data.line.y1,
+                            cmd->data.line.width, cmd->srgb_color);
+                break;
+            case command_clip_rect:
+                render_clip_rect(ctx, cmd->data.clip_rect.min_x, cmd->data.clip_rect.min_y,
+                                 cmd->data.clip_rect.max_x, cmd->data.clip_rect.max_y);
+                break;
+            }
+        }
+        w->command_count = ctx->num_commands - w->command_offset;
     }
+    ctx->occluded = false;
+}
 
-    ctx->mouse_button = button_idle;
+//-----------------------------------------------------------------------------------------------------------------------------
+const ui_frame_stats* ui_get_frame_stats(const ui_context* ctx)
+{
+    return &ctx->stats;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+uint32_t ui_get_culled_widgets(const ui_context* ctx)
+{
+    return ctx->culled_widgets;
+}
+
+
+//-----------------------------------------------------------------------------------------------------------------------------
+const ui_rect* ui_get_dirty_rects(const ui_context* ctx, uint32_t* num_rects)
+{
+    *num_rects = ctx->num_dirty_rects;
+    return ctx->dirty_rects;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+bool ui_is_idle(const ui_context* ctx, float* next_wakeup)
+{
+    if (next_wakeup != NULL)
+        *next_wakeup = (ctx->idle) ? FLT_MAX : 0.f;
+    return ctx->idle;
 }
 
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_set_widget_key(ui_context* ctx, const void* key)
+{
+    ctx->widget_key = key;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+uint32_t ui_color_lerp(const ui_context* ctx, uint32_t a, uint32_t b, float t)
+{
+    t = clamp_float(0.f, 1.f, t);
+    if (t == 0.f)
+        return a;
+    if (t == 1.f)
+        return b;
+    return lerp_color_linear(ctx, a, b, t);
+}
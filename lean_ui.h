@@ -26,7 +26,8 @@ enum ui_text_alignment
 enum ui_window_option
 {
     window_pinned = 1<<0,
-    window_resizable = 1<<1
+    window_resizable = 1<<1,
+    window_scrollable = 1<<2
 };
 
 typedef struct 
@@ -44,12 +45,127 @@ typedef struct
     void* preallocated_buffer;  // must be aligned on 8 bytes
     ui_renderer_fnc_t renderer_callbacks;
     float font_height;
+    void* command_buffer;       // optional, if not NULL draw calls are recorded in this buffer instead of calling the renderer, must be aligned on 8 bytes
+    size_t command_buffer_size; // size in bytes of command_buffer
+    double (*get_time)(void);   // optional, returns a time in seconds, used to time the windows in the frame statistics
+    bool track_dirty_rects;     // optional, computes the screen areas that changed since the last frame, see ui_get_dirty_rects()
 } ui_def;
 
+enum ui_command_type
+{
+    command_box,
+    command_text,
+    command_line,
+    command_clip_rect
+};
+
+typedef struct
+{
+    enum ui_command_type type;
+    uint32_t srgb_color;
+    union
+    {
+        struct {float x, y, width, height, radius;} box;
+        struct {float x, y; const char* text; uint32_t length;} text;   // text is stored in the command buffer
+        struct {float x0, y0, x1, y1, width;} line;
+        struct {uint16_t min_x, min_y, max_x, max_y;} clip_rect;
+    } data;
+} ui_command;
+
 typedef struct {float x, y, width, height;} ui_rect;
 
+typedef struct
+{
+    const char* name;
+    uint32_t widgets;           // culled widgets included
+    uint32_t culled_widgets;
+    float build_time;           // in seconds, from ui_begin_window to ui_end_window, 0 if ui_def.get_time is NULL
+} ui_window_stats;
+
+typedef struct
+{
+    uint32_t draw_box;          // draw calls, to the renderer or recorded in the command buffer
+    uint32_t draw_text;
+    uint32_t draw_line;
+    uint32_t set_clip_rect;
+    uint32_t text_width;        // calls to the text_width callback, cached results excluded
+    uint32_t bytes_formatted;   // bytes written by the formatting of texts and values
+    uint32_t widgets;
+    uint32_t culled_widgets;
+    uint32_t active_animations;
+    uint32_t num_windows;       // windows begun during the frame
+    const ui_window_stats* windows;
+} ui_frame_stats;
+
+// min and max of blocks of samples of a plot at two resolutions, kept up to date by the caller with
+// ui_plot_summary_update()
+typedef struct
+{
+    float* min_values;          // user-allocated, ui_plot_summary_size() values
+    float* max_values;
+    uint32_t block_size;        // in samples, 16 is a good start. The capacity of the ring buffer must be a multiple of it.
+} ui_plot_summary;
+
+// ring buffer of samples shown by ui_plot(), the samples must not be NaN
+typedef struct
+{
+    const float* samples;
+    uint32_t capacity;          // number of samples of the buffer
+    uint32_t first;             // index of the oldest sample to show
+    uint32_t count;             // number of samples to show, wrapping around the end of the buffer
+    const ui_plot_summary* summary;     // optional, the plot reads whole blocks from the summary
+} ui_plot_data;
+
+typedef struct
+{
+    const char* name;
+    float width;                // in pixels, changed when the user drags the right edge of the header
+} ui_table_column;
+
+// table shown by ui_table(), owned by the caller and kept between frames
+typedef struct
+{
+    ui_table_column* columns;
+    uint32_t num_columns;
+    uint32_t num_rows;          // rows of the dataset, rows added at the end between frames are inserted in the order
+    uint32_t* order;            // user-allocated, one entry per row, the rows in display order
+    uint32_t num_sorted;        // rows in [order], set to 0 to sort again (e.g. after removing rows)
+    int32_t sort_column;        // -1 for the dataset order, changed by a click on a header
+    bool descending;
+
+    // text of a cell, the string must stay valid until the next call
+    const char* (*cell_text)(uint32_t row, uint32_t column, void* user);
+
+    // optional, negative if row_a comes first, 0 if equal, positive otherwise. The table is not sortable if NULL.
+    int (*compare_rows)(uint32_t row_a, uint32_t row_b, uint32_t column, void* user);
+    void* user;
+} ui_table_data;
+
+// log shown by ui_log(), owned by the caller and kept between frames. The text is read in place (e.g. a memory-mapped
+// file) and can grow between frames, only the bytes added since the last frame are indexed.
+typedef struct
+{
+    const char* text;           // lines separated by '\n', not NUL-terminated
+    size_t length;              // bytes of text, set it to a smaller value with num_lines = 0 if the text is replaced
+    size_t* line_starts;        // user-allocated, offset of the first byte of each indexed line
+    uint32_t max_lines;         // entries of line_starts, the oldest half of the lines is dropped when it is full
+    uint32_t num_lines;         // indexed lines, set it to 0 to index the text again
+    size_t indexed_length;      // bytes of text already indexed
+    uint32_t first_line;        // index of the first visible line, changed by the wheel and the scrollbar
+    bool follow_tail;           // keeps the last line visible, cleared when the user scrolls up and set at the bottom
+} ui_log_data;
+
 typedef struct ui_context ui_context;
 
+// FNV-1a hash of a string literal (up to 64 characters) folded by the compiler, same value as ui_id()
+// usage : ui_begin_window_id(ctx, UI_ID("Settings"), "Settings", ...)
+// A pointer or a longer literal does not compile : "" s only accepts a literal, the array size fails above 64 characters.
+#define UI_ID_STEP(s, i, h) (((h) ^ (uint8_t)((i) < sizeof(s) - 1 ? (s)[(i) < sizeof(s) - 1 ? (i) : 0] : 0)) * ((i) < sizeof(s) - 1 ? 0x01000193u : 1u))
+#define UI_ID_4(s, i, h) UI_ID_STEP(s, i+3, UI_ID_STEP(s, i+2, UI_ID_STEP(s, i+1, UI_ID_STEP(s, i, h))))
+#define UI_ID_16(s, i, h) UI_ID_4(s, i+12, UI_ID_4(s, i+8, UI_ID_4(s, i+4, UI_ID_4(s, i, h))))
+#define UI_ID_CHECK(s) (0u * sizeof(char[(sizeof("" s) <= 65) ? 1 : -1]))
+#define UI_ID(s) ((uint32_t) (UI_ID_16(s, 48, UI_ID_16(s, 32, UI_ID_16(s, 16, UI_ID_16(s, 0, 0x811c9dc5u)))) + UI_ID_CHECK(s)))
+
 //-----------------------------------------------------------------------------------------------------------------------------
 // api
 //-----------------------------------------------------------------------------------------------------------------------------
@@ -67,6 +183,8 @@ size_t ui_min_memory_size(void);
 //      [preallocated_buffer]   user-allocated memory of ui_min_memory_size() bytes, must be aligned on sizeof(uintptr_t)
 //      [renderer_callbacks]    user-provided drawing callbacks
 //      [font_height]           height in pixels of the font
+//      [command_buffer]        optional, user-allocated memory to record draw commands (deferred mode)
+//                              in that mode only the text_width callback is required
 ui_context* ui_init(const ui_def* def);
 
 //-----------------------------------------------------------------------------------------------------------------------------
@@ -77,20 +195,43 @@ void ui_update_mouse_pos(ui_context* ctx, float x, float y);
 // we care only about one button
 void ui_update_mouse_button(ui_context* ctx, enum ui_button_state button);
 
+//-----------------------------------------------------------------------------------------------------------------------------
+// Mouse wheel movement since the last call, positive when scrolling up. Scrolls the window under the mouse
+void ui_update_mouse_wheel(ui_context* ctx, float delta);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Copies the mouse state of [src], call it before ui_begin_frame() on the contexts building windows on other threads.
+// When the windows of [ctx] are merged in [src], they take the z order of [src] and only the topmost window of all
+// the contexts merged in [src] receives the inputs.
+void ui_copy_input(ui_context* ctx, const ui_context* src);
+
 //-----------------------------------------------------------------------------------------------------------------------------
 // [delta_time]    elapsed time in seconds since the previous frame
 void ui_begin_frame(ui_context* ctx, float delta_time);
 
 //-----------------------------------------------------------------------------------------------------------------------------
-// Begins a new window
+// Begins a new window. Only the topmost window under the mouse receives the inputs. In deferred mode a click brings a
+// window to the front and the commands are sorted back to front at ui_end_frame(). With the renderer callbacks the
+// windows are drawn in call order, the last window called is the topmost. A window fully covered by another one does
+// not draw anything.
 //      [name]                  unique name, hashed under the hood
 //      [x, y, width, height]   initial position and size in pixels can be changed by the user
 //      [options]               combination of options from enum ui_window_option
 void ui_begin_window(ui_context* ctx, const char* name, float x, float y, float width, float height, uint32_t options);
 
+//-----------------------------------------------------------------------------------------------------------------------------
+// Same as ui_begin_window() with a precomputed id, see ui_id() and UI_ID()
+//      [id]                    unique id of the window, the lookup cost does not depend on the number of windows
+//      [name]                  title of the window
+void ui_begin_window_id(ui_context* ctx, uint32_t id, const char* name, float x, float y, float width, float height, uint32_t options);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the id of a window name, hash it once and use ui_begin_window_id()
+uint32_t ui_id(const char* name);
+
 //-----------------------------------------------------------------------------------------------------------------------------
 // Displays text according to the alignment
-//      [string]    can contains format expression (i.e %f) and additionnal parameters
+//      [string]    can contains format expression (i.e %f) and additionnal parameters, without '%' the string is not copied
 void ui_text(ui_context* ctx, enum ui_text_alignment alignment, const char* string, ...);
 
 //-----------------------------------------------------------------------------------------------------------------------------
@@ -108,6 +249,17 @@ void ui_separator(ui_context* ctx);
 //      [fmt]       printf-style format string for the value
 void ui_value(ui_context* ctx, const char* label, const char* fmt, ...);
 
+//-----------------------------------------------------------------------------------------------------------------------------
+// Same as ui_value() for a float, formatted without printf (same output as "%.*f"), much faster for panels full of numbers
+//      [precision]     number of digits after the decimal point, up to 9
+//      [unit]          optional text appended to the number (e.g. " ms"), can be NULL
+void ui_value_float(ui_context* ctx, const char* label, float value, uint32_t precision, const char* unit);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Same as ui_value() for an integer, formatted without printf
+//      [unit]          optional text appended to the number, can be NULL
+void ui_value_int(ui_context* ctx, const char* label, int32_t value, const char* unit);
+
 //-----------------------------------------------------------------------------------------------------------------------------
 // Displays a toggle with a label
 //      [value]     pointer to a bool, toggled on click
@@ -128,6 +280,11 @@ void ui_segmented(ui_context* ctx, const char** entries, uint32_t num_entries, u
 //      [fmt]          printf-style format for the displayed numeric value
 void ui_slider(ui_context* ctx, const char* label, float min_value, float max_value, float step, float* value, const char* fmt);
 
+//-----------------------------------------------------------------------------------------------------------------------------
+// Same as ui_slider() with the value formatted without printf, see ui_value_float()
+void ui_slider_float(ui_context* ctx, const char* label, float min_value, float max_value, float step, float* value,
+                     uint32_t precision, const char* unit);
+
 //-----------------------------------------------------------------------------------------------------------------------------
 // Displays a clickable button
 //      [alignment]    horizontal alignment of the the button in the window
@@ -143,10 +300,127 @@ bool ui_button(ui_context* ctx, const char* label, enum ui_text_alignment alignm
 //      [value]         pointer to the controlled float
 void ui_knob(ui_context* ctx, const char* label, float min_value, float max_value, float default_value, float* value);
 
+//-----------------------------------------------------------------------------------------------------------------------------
+// Displays an array of knobs in a grid starting on the current line, same look and behavior as ui_knob() at a lower
+// cost per knob. Only the visible rows are drawn, the layout is moved to the line after the grid. Each knob counts as
+// a widget in the frame stats, culled or not.
+//      [labels]        optional, one label per knob
+//      [columns]       knobs per row
+//      [values]        array of num_knobs floats, each knob is identified by the address of its value
+void ui_knob_bank(ui_context* ctx, const char* const* labels, uint32_t num_knobs, uint32_t columns,
+                  float min_value, float max_value, float default_value, float* values);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Displays the samples of a ring buffer as a line, on its own row. The samples covered by each pixel column are
+// reduced to their min and max, with a summary only the blocks at the edges of the columns are read.
+//      [label]         optional, shown in the top left corner
+//      [min_value]     value at the bottom of the plot
+//      [max_value]     value at the top of the plot
+//      [height]        height of the row in pixels, 0 for 4 rows
+void ui_plot(ui_context* ctx, const char* label, const ui_plot_data* data, float min_value, float max_value, float height);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the number of values of ui_plot_summary.min_values and max_values for a ring buffer of [capacity] samples
+uint32_t ui_plot_summary_size(uint32_t capacity, uint32_t block_size);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Updates the blocks of the summary covering the samples [first, first + count) of the ring buffer, call it after
+// writing samples
+void ui_plot_summary_update(const ui_plot_summary* summary, const float* samples, uint32_t capacity, uint32_t first, uint32_t count);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Adds the values to [num_bins] bins covering [min_value, max_value], the values outside of the range go to the first
+// or the last bin. The bins are not cleared, a histogram can be built over several calls. The values must not be NaN.
+void ui_histogram_bin(const float* values, uint32_t count, float min_value, float max_value, uint32_t* bins, uint32_t num_bins);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Displays bins as bars on its own row, the highest bar takes the whole height
+//      [label]         optional, shown in the top left corner
+//      [height]        height of the row in pixels, 0 for 4 rows
+void ui_histogram(ui_context* ctx, const char* label, const uint32_t* bins, uint32_t num_bins, float height);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Displays a grid of cells on its own row, the values are mapped to a ramp from colors.widget_bg to colors.accent.
+// Neighbor cells of a row with the same color are drawn as one box.
+//      [cells]         rows * columns values, row by row, must not be NaN
+//      [min_value]     value of the widget_bg color
+//      [max_value]     value of the accent color
+//      [height]        height of the row in pixels, 0 for 4 rows
+void ui_heatmap(ui_context* ctx, const char* label, const float* cells, uint32_t columns, uint32_t rows,
+                float min_value, float max_value, float height);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Displays a table with a header row, starting on the current line. Only the rows intersecting the clip rect are
+// drawn, use a window_scrollable window for large tables. The cells of a column are clipped to the column.
+void ui_table(ui_context* ctx, ui_table_data* table);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Moves a row whose data changed to its new place in the order, no-op if the table is not sorted
+void ui_table_row_changed(ui_table_data* table, uint32_t row);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Displays a read-only text on its own row with a scrollbar. Only the visible lines are drawn, each line is read from
+// the text with the index (the lines longer than 512 bytes are cut). Up to 16 MB of new text is indexed per call,
+// a larger text is indexed over several frames. Use a window without window_scrollable, the window takes the mouse
+// wheel otherwise.
+//      [height]        height of the row in pixels, 0 for 4 rows
+void ui_log(ui_context* ctx, ui_log_data* log, float height);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// The widgets with a state (toggle, segmented, slider, button, knob) are identified by the pointer to their value
+// (the label for a button) to keep their animation and dragging between frames. Sets the identity of the next of
+// these widgets, useful when the value is a temporary copy (e.g. a slider on an integer)
+void ui_set_widget_key(ui_context* ctx, const void* key);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Virtualized list, only the visible items are returned. Each item starts on a new line and its widgets must fit
+// in [item_height]. Use in a window_scrollable window to show large lists at a constant cost.
+//      [num_items]     total number of items
+//      [item_height]   height of an item in pixels, 0 for the default row height
+//
+//      ui_list_begin(ctx, num_entities, 0.f);
+//      for(uint32_t i; ui_list_next(ctx, &i); )
+//          ui_value(ctx, entities[i].name, "%d", entities[i].health);
+void ui_list_begin(ui_context* ctx, uint32_t num_items, float item_height);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Moves the layout to the next visible item and returns its index in [index]
+// returns false when there is no more visible item, the layout is then moved after the end of the list
+bool ui_list_next(ui_context* ctx, uint32_t* index);
+
 //-----------------------------------------------------------------------------------------------------------------------------
 // Returns the current layout rect, useful for custom rendering
 const ui_rect* ui_get_layout(const ui_context* ctx);
 
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the number of widgets skipped during the current frame because they were outside of the window clip rect
+uint32_t ui_get_culled_widgets(const ui_context* ctx);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Interpolates two colors (0xAABBGGRR, sRGB) in linear space like the widget transitions, alpha is interpolated as is
+//      [t]     clamped to [0, 1], returns a for 0 and b for 1
+uint32_t ui_color_lerp(const ui_context* ctx, uint32_t a, uint32_t b, float t);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the counters of the last frame, valid after ui_end_frame() until the next ui_begin_frame()
+// All counters are 0 if lean_ui.c is compiled with UI_STATS defined to 0
+const ui_frame_stats* ui_get_frame_stats(const ui_context* ctx);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the screen areas that changed since the last frame, valid after ui_end_frame() until the next ui_begin_frame()
+// The primitives of the chrome of each window and of each widget are hashed and compared with the last frame, the
+// bounds of the changes are merged in up to 16 rects. A backend can repaint only these areas, an idle frame
+// returns no rect. Needs ui_def.track_dirty_rects, returns no rect otherwise.
+const ui_rect* ui_get_dirty_rects(const ui_context* ctx, uint32_t* num_rects);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns true if nothing will change on screen until the next input, valid after ui_end_frame(). The ui is not idle
+// while an animation (tween, hover fade) is running, a window or a widget is dragged or resized, or during the frame
+// following an input. The application can then wait for input events instead of building frames at a fixed rate.
+//      [next_wakeup]   optional, seconds before the next frame is needed without any input : 0 if the ui is not idle,
+//                      FLT_MAX otherwise
+bool ui_is_idle(const ui_context* ctx, float* next_wakeup);
+
 //-----------------------------------------------------------------------------------------------------------------------------
 // Ends the current window. Must match ui_begin_window()
 void ui_end_window(ui_context* ctx);
@@ -155,8 +429,62 @@ void ui_end_window(ui_context* ctx);
 // Ends the current frame. Must match ui_begin_frame(). Until next frame no more calls to lean_ui.
 void ui_end_frame(ui_context* ctx);
 
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the draw commands recorded during the frame, only in deferred mode (see ui_def.command_buffer)
+// The commands are valid after ui_end_frame() until the next ui_begin_frame()
+//      [num_commands]  number of commands in the returned array
+const ui_command* ui_get_commands(const ui_context* ctx, uint32_t* num_commands);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Appends the commands of the windows built during the last frame of [src] to the commands of [ctx], both contexts
+// must be in deferred mode. Windows can be built on several threads, one context per thread, then merged on the
+// main thread between ui_begin_frame() and ui_end_frame() outside of a window.
+//      [src]   context after its ui_end_frame(), its windows are merged back to front
+//
+// Each window of [src] gets a window in [ctx] sorted with the other windows of [ctx] at ui_end_frame(), a click brings
+// it to the front. The window ids must be unique across the contexts.
+//
+//      // on each worker thread, with its own context and command buffer
+//      ui_copy_input(worker_ctx, main_ctx);
+//      ui_begin_frame(worker_ctx, delta_time);
+//      ... windows ...
+//      ui_end_frame(worker_ctx);
+//
+//      // on the main thread once the workers are done
+//      ui_begin_frame(main_ctx, delta_time);
+//      for(uint32_t i=0; i<num_workers; ++i)
+//          ui_merge_commands(main_ctx, worker_ctx[i]);
+//      ui_end_frame(main_ctx);
+//
+// The text_width callback is called from the worker threads, it has to be thread-safe
+void ui_merge_commands(ui_context* ctx, const ui_context* src);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// The results of text_width are cached, call this function when the font changes
+void ui_invalidate_text_cache(ui_context* ctx);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the number of hits and misses of the text width cache since ui_init(), useful to check if the cache is big enough
+void ui_get_text_cache_stats(const ui_context* ctx, uint32_t* hits, uint32_t* misses);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Calls the renderer callbacks for an array of commands, useful to replay a frame or to render on another thread
+void ui_render_commands(const ui_command* commands, uint32_t num_commands, const ui_renderer_fnc_t* renderer);
+
 #ifdef __cplusplus
 }
 #endif
 
+//-----------------------------------------------------------------------------------------------------------------------------
+// Header-only build : define LEAN_UI_IMPLEMENTATION before including lean_ui.h in one C file, lean_ui.c is compiled
+// in this file and must be next to lean_ui.h. Define the UI_RENDERER_* macros (see lean_ui.c) to the renderer
+// functions declared before the include to bind them at compile time, the compiler can then inline them in the widgets.
+//
+//      #define UI_RENDERER_DRAW_BOX my_draw_box
+//      #define LEAN_UI_IMPLEMENTATION
+//      #include "lean_ui.h"
+#ifdef LEAN_UI_IMPLEMENTATION
+#include "lean_ui.c"
+#endif
+
 #endif
\ No newline at end of file
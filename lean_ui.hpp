@@ -0,0 +1,196 @@
+#ifndef __LEAN_UI_HPP__
+#define __LEAN_UI_HPP__
+
+#include "lean_ui.h"
+#include <cassert>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// C++17 layer, header-only : scopes for the frame and the windows, labels carrying their length and templated widgets.
+// Everything is inlined in the calls of the C api, there is no allocation and no runtime type dispatch.
+//
+//      {
+//          ui::frame frame(ctx, delta_time);
+//          {
+//              ui::window window(ctx, "Settings", 50.f, 50.f, 300.f, 400.f);
+//              ui::slider(ctx, "count", 0, 100, 1, count);
+//              ui::knob(ctx, "gain", 0.0, 1.0, 0.5, gain);
+//          }
+//      }
+//-----------------------------------------------------------------------------------------------------------------------------
+
+namespace ui
+{
+    //-------------------------------------------------------------------------------------------------------------------------
+    // Same value as ui_id() and UI_ID(), evaluated by the compiler for string literals
+    constexpr uint32_t id(std::string_view name)
+    {
+        uint32_t hash = 0x811c9dc5u;
+        for(char c : name)
+            hash = (hash ^ (uint8_t) c) * 0x01000193u;
+        return hash;
+    }
+
+    //-------------------------------------------------------------------------------------------------------------------------
+    // NUL-terminated string and its length, the renderer callbacks still receive a C string. The length of a literal
+    // is known by the compiler.
+    class label
+    {
+    public:
+        constexpr label(const char* string) : m_view(string) {}
+        label(const std::string& string) : m_view(string.data(), string.size()) {}
+
+        // the view must be NUL-terminated (literal, std::string, ...)
+        explicit label(std::string_view terminated) : m_view(terminated) {assert(terminated.data()[terminated.size()] == 0);}
+
+        constexpr const char* c_str() const {return m_view.data();}
+        constexpr std::string_view view() const {return m_view;}
+
+    private:
+        std::string_view m_view;
+    };
+
+    //-------------------------------------------------------------------------------------------------------------------------
+    // ui_begin_frame() ... ui_end_frame()
+    class frame
+    {
+    public:
+        frame(ui_context* ctx, float delta_time) : m_ctx(ctx) {ui_begin_frame(ctx, delta_time);}
+        ~frame() {ui_end_frame(m_ctx);}
+        frame(const frame&) = delete;
+        frame& operator=(const frame&) = delete;
+
+    private:
+        ui_context* m_ctx;
+    };
+
+    //-------------------------------------------------------------------------------------------------------------------------
+    // ui_begin_window() ... ui_end_window(), the id is hashed from the label without strlen
+    class window
+    {
+    public:
+        window(ui_context* ctx, label name, float x, float y, float width, float height, uint32_t options = 0) : m_ctx(ctx)
+        {
+            ui_begin_window_id(ctx, id(name.view()), name.c_str(), x, y, width, height, options);
+        }
+
+        window(ui_context* ctx, uint32_t window_id, label name, float x, float y, float width, float height, uint32_t options = 0) : m_ctx(ctx)
+        {
+            ui_begin_window_id(ctx, window_id, name.c_str(), x, y, width, height, options);
+        }
+
+        ~window() {ui_end_window(m_ctx);}
+        window(const window&) = delete;
+        window& operator=(const window&) = delete;
+
+    private:
+        ui_context* m_ctx;
+    };
+
+    //-------------------------------------------------------------------------------------------------------------------------
+    // the C functions format the strings containing '%', a label is always shown as is
+    inline void text(ui_context* ctx, label string, ui_text_alignment alignment = align_left)
+    {
+        if (string.view().find('%') == std::string_view::npos)
+            ui_text(ctx, alignment, string.c_str());
+        else
+            ui_text(ctx, alignment, "%s", string.c_str());
+    }
+
+    //-------------------------------------------------------------------------------------------------------------------------
+    inline void value(ui_context* ctx, label name, label string)
+    {
+        if (string.view().find('%') == std::string_view::npos)
+            ui_value(ctx, name.c_str(), string.c_str());
+        else
+            ui_value(ctx, name.c_str(), "%s", string.c_str());
+    }
+
+    //-------------------------------------------------------------------------------------------------------------------------
+    // Numbers go through the printf-free formatter
+    //      [precision]     digits after the decimal point, ignored for integers
+    template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    inline void value(ui_context* ctx, label name, T number, uint32_t precision = 2, const char* unit = nullptr)
+    {
+        if constexpr (std::is_integral_v<T>)
+            ui_value_int(ctx, name.c_str(), (int32_t) number, unit);
+        else
+            ui_value_float(ctx, name.c_str(), (float) number, precision, unit);
+    }
+
+    //-------------------------------------------------------------------------------------------------------------------------
+    inline void newline(ui_context* ctx) {ui_newline(ctx);}
+    inline void separator(ui_context* ctx) {ui_separator(ctx);}
+    inline void toggle(ui_context* ctx, label name, bool& value) {ui_toggle(ctx, name.c_str(), &value);}
+
+    //-------------------------------------------------------------------------------------------------------------------------
+    inline bool button(ui_context* ctx, label name, ui_text_alignment alignment = align_left)
+    {
+        return ui_button(ctx, name.c_str(), alignment);
+    }
+
+    //-------------------------------------------------------------------------------------------------------------------------
+    template<size_t N>
+    inline void segmented(ui_context* ctx, const char* (&entries)[N], uint32_t& selected)
+    {
+        ui_segmented(ctx, entries, (uint32_t) N, &selected);
+    }
+
+    //-------------------------------------------------------------------------------------------------------------------------
+    // The widgets work on floats : other types go through a float copy, written back only when the widget changed it
+    // so a double does not lose its precision. Integers are rounded. The widget keeps the identity of the original value,
+    // see ui_set_widget_key().
+    namespace detail
+    {
+        template<typename T>
+        inline void write_back(float edited, float original, T& value)
+        {
+            if (edited == original)
+                return;
+
+            if constexpr (std::is_integral_v<T>)
+                value = (T) std::lround(edited);
+            else
+                value = (T) edited;
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------------------------------
+    //      [precision]     digits after the decimal point of the displayed value, 0 for integers by default
+    template<typename T>
+    inline void slider(ui_context* ctx, label name, T min_value, T max_value, T step, T& value,
+                       uint32_t precision = std::is_integral_v<T> ? 0 : 2, const char* unit = nullptr)
+    {
+        static_assert(std::is_arithmetic_v<T>, "ui::slider() needs a number");
+        if constexpr (std::is_same_v<T, float>)
+            ui_slider_float(ctx, name.c_str(), min_value, max_value, step, &value, precision, unit);
+        else
+        {
+            float edited = (float) value, original = edited;
+            ui_set_widget_key(ctx, &value);
+            ui_slider_float(ctx, name.c_str(), (float) min_value, (float) max_value, (float) step, &edited, precision, unit);
+            detail::write_back(edited, original, value);
+        }
+    }
+
+    //-------------------------------------------------------------------------------------------------------------------------
+    template<typename T>
+    inline void knob(ui_context* ctx, label name, T min_value, T max_value, T default_value, T& value)
+    {
+        static_assert(std::is_arithmetic_v<T>, "ui::knob() needs a number");
+        if constexpr (std::is_same_v<T, float>)
+            ui_knob(ctx, name.c_str(), min_value, max_value, default_value, &value);
+        else
+        {
+            float edited = (float) value, original = edited;
+            ui_set_widget_key(ctx, &value);
+            ui_knob(ctx, name.c_str(), (float) min_value, (float) max_value, (float) default_value, &edited);
+            detail::write_back(edited, original, value);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,247 @@
+#include "lean_ui_mesh.h"
+#include <math.h>
+
+#define MAX_ARC_SEGMENTS (16)
+#define MAX_PATH_POINTS (4 * (MAX_ARC_SEGMENTS + 1))
+#define ARC_TOLERANCE (.25f)
+
+typedef struct {float x, y;} ui_point;
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// number of segments per quarter of circle to keep the error below ARC_TOLERANCE pixel
+static inline uint32_t arc_segments(float radius)
+{
+    float step = acosf(1.f - ARC_TOLERANCE / radius);
+    uint32_t segments = (uint32_t) ceilf(1.5707963f / step);
+    return (segments < 1) ? 1 : (segments > MAX_ARC_SEGMENTS) ? MAX_ARC_SEGMENTS : segments;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// clockwise outline of a rounded box, the corners fit inside the box
+static uint32_t box_path(float x, float y, float width, float height, float radius, ui_point* path)
+{
+    radius = fminf(radius, fminf(width, height) * .5f);
+
+    if (radius < .5f)
+    {
+        path[0] = (ui_point) {x, y};
+        path[1] = (ui_point) {x + width, y};
+        path[2] = (ui_point) {x + width, y + height};
+        path[3] = (ui_point) {x, y + height};
+        return 4;
+    }
+
+    const ui_point centers[4] =
+    {
+        {x + width - radius, y + radius},
+        {x + width - radius, y + height - radius},
+        {x + radius, y + height - radius},
+        {x + radius, y + radius}
+    };
+
+    uint32_t segments = arc_segments(radius);
+    float step = 1.5707963f / (float) segments;
+    uint32_t count = 0;
+
+    for(uint32_t corner=0; corner<4; ++corner)
+    {
+        float start = -1.5707963f + 1.5707963f * (float) corner;
+        for(uint32_t i=0; i<=segments; ++i)
+        {
+            float angle = start + step * (float) i;
+            ui_point p = {centers[corner].x + cosf(angle) * radius, centers[corner].y + sinf(angle) * radius};
+
+            // discs and pills have straight edges of zero length, skip duplicated points
+            if (count > 0 && fabsf(p.x - path[count-1].x) < 1e-3f && fabsf(p.y - path[count-1].y) < 1e-3f)
+                continue;
+
+            path[count++] = p;
+        }
+    }
+
+    if (count > 1 && fabsf(path[0].x - path[count-1].x) < 1e-3f && fabsf(path[0].y - path[count-1].y) < 1e-3f)
+        count--;
+
+    return count;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static uint32_t line_path(float x0, float y0, float x1, float y1, float width, ui_point* path)
+{
+    float dx = x1 - x0, dy = y1 - y0;
+    float length = sqrtf(dx * dx + dy * dy);
+    if (length < 1e-6f)
+        return 0;
+
+    float half_width = width * .5f;
+    float nx = -dy / length * half_width, ny = dx / length * half_width;
+
+    path[0] = (ui_point) {x0 - nx, y0 - ny};
+    path[1] = (ui_point) {x1 - nx, y1 - ny};
+    path[2] = (ui_point) {x1 + nx, y1 + ny};
+    path[3] = (ui_point) {x0 + nx, y0 + ny};
+    return 4;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// convex polygon fill, inner vertices are solid and outer vertices transparent when AA is on
+static bool fill_convex(ui_mesh* mesh, const ui_point* path, uint32_t count, uint32_t srgb_color)
+{
+    if (count < 3)
+        return true;
+
+    const bool aa = mesh->aa_fringe > 0.f;
+    uint32_t num_vertices = aa ? count * 2 : count;
+    uint32_t num_indices = (count - 2) * 3 + (aa ? count * 6 : 0);
+
+    if (mesh->num_vertices + num_vertices > mesh->max_vertices || mesh->num_indices + num_indices > mesh->max_indices)
+        return false;
+
+    uint32_t base = mesh->num_vertices;
+    ui_vertex* vertices = mesh->vertices + mesh->num_vertices;
+    uint32_t* indices = mesh->indices + mesh->num_indices;
+
+    if (!aa)
+    {
+        for(uint32_t i=0; i<count; ++i)
+            vertices[i] = (ui_vertex) {path[i].x, path[i].y, srgb_color};
+
+        for(uint32_t i=1; i<count-1; ++i)
+        {
+            *indices++ = base;
+            *indices++ = base + i;
+            *indices++ = base + i + 1;
+        }
+    }
+    else
+    {
+        // the winding depends on the shape (lines), find the outward side with the signed area
+        float area = 0.f;
+        for(uint32_t i=0, j=count-1; i<count; j=i++)
+            area += path[j].x * path[i].y - path[i].x * path[j].y;
+        float side = (area > 0.f) ? 1.f : -1.f;
+
+        float half_fringe = mesh->aa_fringe * .5f;
+        uint32_t transparent = srgb_color & 0x00FFFFFF;
+
+        for(uint32_t i=0; i<count; ++i)
+        {
+            const ui_point* p0 = &path[(i + count - 1) % count];
+            const ui_point* p1 = &path[i];
+            const ui_point* p2 = &path[(i + 1) % count];
+
+            float d0x = p1->x - p0->x, d0y = p1->y - p0->y;
+            float d1x = p2->x - p1->x, d1y = p2->y - p1->y;
+            float l0 = 1.f / sqrtf(d0x * d0x + d0y * d0y);
+            float l1 = 1.f / sqrtf(d1x * d1x + d1y * d1y);
+
+            // average of the normals of the two edges, scaled to keep the fringe width constant
+            float nx = (d0y * l0 + d1y * l1) * .5f * side;
+            float ny = -(d0x * l0 + d1x * l1) * .5f * side;
+            float inv_len2 = fminf(1.f / fmaxf(nx * nx + ny * ny, 1e-6f), 100.f);
+            nx *= inv_len2 * half_fringe;
+            ny *= inv_len2 * half_fringe;
+
+            vertices[i*2] = (ui_vertex) {p1->x - nx, p1->y - ny, srgb_color};
+            vertices[i*2+1] = (ui_vertex) {p1->x + nx, p1->y + ny, transparent};
+        }
+
+        for(uint32_t i=1; i<count-1; ++i)
+        {
+            *indices++ = base;
+            *indices++ = base + i * 2;
+            *indices++ = base + (i + 1) * 2;
+        }
+
+        for(uint32_t i=0; i<count; ++i)
+        {
+            uint32_t inner0 = base + i * 2, outer0 = inner0 + 1;
+            uint32_t inner1 = base + ((i + 1) % count) * 2, outer1 = inner1 + 1;
+
+            *indices++ = inner0; *indices++ = outer0; *indices++ = outer1;
+            *indices++ = inner0; *indices++ = outer1; *indices++ = inner1;
+        }
+    }
+
+    mesh->num_vertices += num_vertices;
+    mesh->num_indices += num_indices;
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static bool push_draw_call(ui_mesh* mesh, uint16_t min_x, uint16_t min_y, uint16_t max_x, uint16_t max_y, uint32_t command_offset)
+{
+    // discard the previous draw call if it's empty
+    if (mesh->num_draw_calls > 0)
+    {
+        ui_draw_call* last = &mesh->draw_calls[mesh->num_draw_calls - 1];
+        if (last->index_count == 0 && last->command_count == 0)
+            mesh->num_draw_calls--;
+    }
+
+    if (mesh->num_draw_calls >= mesh->max_draw_calls)
+        return false;
+
+    mesh->draw_calls[mesh->num_draw_calls++] = (ui_draw_call)
+    {
+        .clip_min_x = min_x, .clip_min_y = min_y, .clip_max_x = max_x, .clip_max_y = max_y,
+        .index_offset = mesh->num_indices,
+        .command_offset = command_offset
+    };
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+bool ui_tessellate(const ui_command* commands, uint32_t num_commands, ui_mesh* mesh)
+{
+    mesh->num_vertices = mesh->num_indices = mesh->num_draw_calls = 0;
+
+    if (!push_draw_call(mesh, 0, 0, UINT16_MAX, UINT16_MAX, 0))
+        return false;
+
+    ui_point path[MAX_PATH_POINTS];
+    bool success = true;
+
+    for(uint32_t i=0; i<num_commands && success; ++i)
+    {
+        const ui_command* cmd = &commands[i];
+        uint32_t count = 0;
+
+        switch(cmd->type)
+        {
+        case command_clip_rect:
+            success = push_draw_call(mesh, cmd->data.clip_rect.min_x, cmd->data.clip_rect.min_y,
+                                     cmd->data.clip_rect.max_x, cmd->data.clip_rect.max_y, i + 1);
+            continue;
+        case command_box:
+            count = box_path(cmd->data.box.x, cmd->data.box.y, cmd->data.box.width, cmd->data.box.height,
+                             cmd->data.box.radius, path);
+            break;
+        case command_line:
+            count = line_path(cmd->data.line.x0, cmd->data.line.y0, cmd->data.line.x1, cmd->data.line.y1,
+                              cmd->data.line.width, path);
+            break;
+        case command_text:
+            break;
+        }
+
+        uint32_t first_index = mesh->num_indices;
+        success = fill_convex(mesh, path, count, cmd->srgb_color);
+        if (success)
+        {
+            ui_draw_call* draw = &mesh->draw_calls[mesh->num_draw_calls - 1];
+            draw->index_count += mesh->num_indices - first_index;
+            draw->command_count = i + 1 - draw->command_offset;
+        }
+    }
+
+    // remove trailing empty draw call
+    if (mesh->num_draw_calls > 0)
+    {
+        ui_draw_call* last = &mesh->draw_calls[mesh->num_draw_calls - 1];
+        if (last->index_count == 0 && last->command_count == 0)
+            mesh->num_draw_calls--;
+    }
+
+    return success;
+}
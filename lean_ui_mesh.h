@@ -0,0 +1,56 @@
+#ifndef __LEAN_UI_MESH_H__
+#define __LEAN_UI_MESH_H__
+
+#include "lean_ui.h"
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Optional module : converts the commands recorded in deferred mode into a single interleaved vertex/index stream
+// Boxes (rounded or not), discs and lines are tessellated with an anti-aliasing fringe, texts are left to the renderer.
+//-----------------------------------------------------------------------------------------------------------------------------
+
+typedef struct
+{
+    float x, y;
+    uint32_t srgb_color;
+} ui_vertex;
+
+typedef struct
+{
+    uint16_t clip_min_x, clip_min_y, clip_max_x, clip_max_y;
+    uint32_t index_offset;      // first index of the draw call in ui_mesh.indices
+    uint32_t index_count;
+    uint32_t command_offset;    // range of commands covered by the draw call, use it to render the texts of the draw call
+    uint32_t command_count;
+} ui_draw_call;
+
+typedef struct
+{
+    ui_vertex* vertices;        // user-allocated arrays
+    uint32_t* indices;
+    ui_draw_call* draw_calls;
+    uint32_t max_vertices;
+    uint32_t max_indices;
+    uint32_t max_draw_calls;
+    float aa_fringe;            // width in pixels of the anti-aliasing fringe (1.f is a good value), 0.f disables AA
+
+    uint32_t num_vertices;      // output
+    uint32_t num_indices;
+    uint32_t num_draw_calls;
+} ui_mesh;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Tessellates an array of commands (see ui_get_commands), draw calls are split on each clip rect change
+// Triangles are clockwise in screen space (y down). Indices are relative to the start of ui_mesh.vertices.
+//
+// returns false if the mesh arrays are too small, the mesh then contains the commands that fit
+bool ui_tessellate(const ui_command* commands, uint32_t num_commands, ui_mesh* mesh);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
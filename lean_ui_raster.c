@@ -0,0 +1,604 @@
+#include "lean_ui_raster.h"
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+
+#define TILE_SIZE (64)
+#define TILE_ENTRIES_PER_COMMAND (8)    // average number of tiles touched by a command, sizes the bins
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// SIMD abstraction : the coverage kernels process SIMD_LANES pixels at once
+//-----------------------------------------------------------------------------------------------------------------------------
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define SIMD_LANES (8)
+    typedef __m256 vfloat;
+    typedef __m256i vint;
+    static inline vfloat vf_set1(float f) {return _mm256_set1_ps(f);}
+    static inline vfloat vf_ramp(float f) {return _mm256_add_ps(_mm256_set1_ps(f), _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f));}
+    static inline vfloat vf_add(vfloat a, vfloat b) {return _mm256_add_ps(a, b);}
+    static inline vfloat vf_sub(vfloat a, vfloat b) {return _mm256_sub_ps(a, b);}
+    static inline vfloat vf_mul(vfloat a, vfloat b) {return _mm256_mul_ps(a, b);}
+    static inline vfloat vf_min(vfloat a, vfloat b) {return _mm256_min_ps(a, b);}
+    static inline vfloat vf_max(vfloat a, vfloat b) {return _mm256_max_ps(a, b);}
+    static inline vfloat vf_sqrt(vfloat a) {return _mm256_sqrt_ps(a);}
+    static inline vfloat vf_abs(vfloat a) {return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a);}
+    static inline vint vi_load(const uint32_t* p) {return _mm256_loadu_si256((const __m256i*) p);}
+    static inline void vi_store(uint32_t* p, vint v) {_mm256_storeu_si256((__m256i*) p, v);}
+    static inline vint vi_or(vint a, vint b) {return _mm256_or_si256(a, b);}
+    static inline vfloat vi_channel(vint v, int shift) {return _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srl_epi32(v, _mm_cvtsi32_si128(shift)), _mm256_set1_epi32(0xFF)));}
+    static inline vint vf_to_channel(vfloat v, int shift) {return _mm256_sll_epi32(_mm256_cvttps_epi32(v), _mm_cvtsi32_si128(shift));}
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SIMD_LANES (4)
+    typedef __m128 vfloat;
+    typedef __m128i vint;
+    static inline vfloat vf_set1(float f) {return _mm_set1_ps(f);}
+    static inline vfloat vf_ramp(float f) {return _mm_add_ps(_mm_set1_ps(f), _mm_setr_ps(0.f, 1.f, 2.f, 3.f));}
+    static inline vfloat vf_add(vfloat a, vfloat b) {return _mm_add_ps(a, b);}
+    static inline vfloat vf_sub(vfloat a, vfloat b) {return _mm_sub_ps(a, b);}
+    static inline vfloat vf_mul(vfloat a, vfloat b) {return _mm_mul_ps(a, b);}
+    static inline vfloat vf_min(vfloat a, vfloat b) {return _mm_min_ps(a, b);}
+    static inline vfloat vf_max(vfloat a, vfloat b) {return _mm_max_ps(a, b);}
+    static inline vfloat vf_sqrt(vfloat a) {return _mm_sqrt_ps(a);}
+    static inline vfloat vf_abs(vfloat a) {return _mm_andnot_ps(_mm_set1_ps(-0.f), a);}
+    static inline vint vi_load(const uint32_t* p) {return _mm_loadu_si128((const __m128i*) p);}
+    static inline void vi_store(uint32_t* p, vint v) {_mm_storeu_si128((__m128i*) p, v);}
+    static inline vint vi_or(vint a, vint b) {return _mm_or_si128(a, b);}
+    static inline vfloat vi_channel(vint v, int shift) {return _mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(v, _mm_cvtsi32_si128(shift)), _mm_set1_epi32(0xFF)));}
+    static inline vint vf_to_channel(vfloat v, int shift) {return _mm_sll_epi32(_mm_cvttps_epi32(v), _mm_cvtsi32_si128(shift));}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+    #define SIMD_LANES (4)
+    typedef float32x4_t vfloat;
+    typedef uint32x4_t vint;
+    static inline vfloat vf_set1(float f) {return vdupq_n_f32(f);}
+    static inline vfloat vf_ramp(float f) {const float ramp[4] = {0.f, 1.f, 2.f, 3.f}; return vaddq_f32(vdupq_n_f32(f), vld1q_f32(ramp));}
+    static inline vfloat vf_add(vfloat a, vfloat b) {return vaddq_f32(a, b);}
+    static inline vfloat vf_sub(vfloat a, vfloat b) {return vsubq_f32(a, b);}
+    static inline vfloat vf_mul(vfloat a, vfloat b) {return vmulq_f32(a, b);}
+    static inline vfloat vf_min(vfloat a, vfloat b) {return vminq_f32(a, b);}
+    static inline vfloat vf_max(vfloat a, vfloat b) {return vmaxq_f32(a, b);}
+    static inline vfloat vf_sqrt(vfloat a) {return vsqrtq_f32(a);}
+    static inline vfloat vf_abs(vfloat a) {return vabsq_f32(a);}
+    static inline vint vi_load(const uint32_t* p) {return vld1q_u32(p);}
+    static inline void vi_store(uint32_t* p, vint v) {vst1q_u32(p, v);}
+    static inline vint vi_or(vint a, vint b) {return vorrq_u32(a, b);}
+    static inline vfloat vi_channel(vint v, int shift) {return vcvtq_f32_u32(vandq_u32(vshlq_u32(v, vdupq_n_s32(-shift)), vdupq_n_u32(0xFF)));}
+    static inline vint vf_to_channel(vfloat v, int shift) {return vshlq_u32(vcvtq_u32_f32(v), vdupq_n_s32(shift));}
+#else
+    #define SIMD_LANES (1)
+    typedef float vfloat;
+    typedef uint32_t vint;
+    static inline vfloat vf_set1(float f) {return f;}
+    static inline vfloat vf_ramp(float f) {return f;}
+    static inline vfloat vf_add(vfloat a, vfloat b) {return a + b;}
+    static inline vfloat vf_sub(vfloat a, vfloat b) {return a - b;}
+    static inline vfloat vf_mul(vfloat a, vfloat b) {return a * b;}
+    static inline vfloat vf_min(vfloat a, vfloat b) {return fminf(a, b);}
+    static inline vfloat vf_max(vfloat a, vfloat b) {return fmaxf(a, b);}
+    static inline vfloat vf_sqrt(vfloat a) {return sqrtf(a);}
+    static inline vfloat vf_abs(vfloat a) {return fabsf(a);}
+    static inline vint vi_load(const uint32_t* p) {return *p;}
+    static inline void vi_store(uint32_t* p, vint v) {*p = v;}
+    static inline vint vi_or(vint a, vint b) {return a | b;}
+    static inline vfloat vi_channel(vint v, int shift) {return (float) ((v >> shift) & 0xFF);}
+    static inline vint vf_to_channel(vfloat v, int shift) {return ((uint32_t) v) << shift;}
+#endif
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Structures
+//-----------------------------------------------------------------------------------------------------------------------------
+
+typedef struct {int32_t min_x, min_y, max_x, max_y;} ui_irect;
+
+typedef struct
+{
+    float channels[4];  // r, g, b and 255 for the alpha channel
+    float alpha;        // [0; 1]
+    uint32_t srgb_color;
+} ui_raster_color;
+
+struct ui_raster
+{
+    ui_raster_def def;
+    ui_command* commands;
+    ui_irect* bounds;
+    char* text_buffer;
+    uint32_t num_commands;
+    uint32_t text_offset;
+    uint32_t tiles_x, tiles_y;
+    ui_irect clip;
+
+    // bins : the commands of tile t are tile_commands[tile_first[t]] to tile_commands[tile_first[t+1]-1], in order
+    uint32_t* tile_first;       // num_tiles + 1
+    uint32_t* tile_cursor;      // num_tiles
+    uint32_t* tile_commands;
+    uint32_t max_tile_commands;
+
+    // batch being rasterized
+    const ui_command* batch;
+    uint32_t batch_size;
+};
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Kernels
+//-----------------------------------------------------------------------------------------------------------------------------
+
+static inline ui_raster_color unpack_color(uint32_t srgb_color)
+{
+    ui_raster_color c =
+    {
+        .channels = {(float)(srgb_color & 0xFF), (float)((srgb_color >> 8) & 0xFF), (float)((srgb_color >> 16) & 0xFF), 255.f},
+        .alpha = (float)(srgb_color >> 24) / 255.f,
+        .srgb_color = srgb_color
+    };
+    return c;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline float clamp_coverage(float coverage) {return fminf(fmaxf(coverage, 0.f), 1.f);}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline void blend_pixel(uint32_t* pixel, float coverage, const ui_raster_color* color)
+{
+    uint32_t dst = *pixel, result = 0;
+    for(int i=0; i<4; ++i)
+    {
+        float d = (float)((dst >> (i*8)) & 0xFF);
+        result |= ((uint32_t)(d + (color->channels[i] - d) * coverage + .5f)) << (i*8);
+    }
+    *pixel = result;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline void blend_pixels(uint32_t* pixels, vfloat coverage, const ui_raster_color* color)
+{
+    vint dst = vi_load(pixels);
+    vint result = vf_to_channel(vf_set1(0.f), 0);
+    for(int i=0; i<4; ++i)
+    {
+        vfloat d = vi_channel(dst, i*8);
+        vfloat c = vf_add(vf_add(d, vf_mul(vf_sub(vf_set1(color->channels[i]), d), coverage)), vf_set1(.5f));
+        result = vi_or(result, vf_to_channel(c, i*8));
+    }
+    vi_store(pixels, result);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// rounded box signed distance, see https://iquilezles.org/articles/distfunctions2d/
+typedef struct {float cx, cy, bx, by, radius;} ui_box_shape;
+
+static inline float box_coverage(const ui_box_shape* s, float px, float qy)
+{
+    float qx = fabsf(px - s->cx) - s->bx + s->radius;
+    float d = sqrtf(fmaxf(qx, 0.f) * fmaxf(qx, 0.f) + fmaxf(qy, 0.f) * fmaxf(qy, 0.f)) + fminf(fmaxf(qx, qy), 0.f) - s->radius;
+    return clamp_coverage(.5f - d);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void box_span(uint32_t* row, int32_t x0, int32_t x1, float py, const ui_box_shape* s, const ui_raster_color* color)
+{
+    float qy = fabsf(py - s->cy) - s->by + s->radius;
+    int32_t x = x0;
+
+    vfloat v_cx = vf_set1(s->cx), v_offset = vf_set1(s->radius - s->bx), v_radius = vf_set1(s->radius);
+    vfloat v_qy = vf_set1(qy), v_qy2 = vf_set1(fmaxf(qy, 0.f) * fmaxf(qy, 0.f));
+    vfloat v_alpha = vf_set1(color->alpha), v_half = vf_set1(.5f), v_zero = vf_set1(0.f), v_one = vf_set1(1.f);
+
+    for(; x + SIMD_LANES <= x1; x += SIMD_LANES)
+    {
+        vfloat qx = vf_add(vf_abs(vf_sub(vf_ramp((float)x + .5f), v_cx)), v_offset);
+        vfloat qx_pos = vf_max(qx, v_zero);
+        vfloat d = vf_add(vf_sqrt(vf_add(vf_mul(qx_pos, qx_pos), v_qy2)), vf_sub(vf_min(vf_max(qx, v_qy), v_zero), v_radius));
+        vfloat coverage = vf_mul(vf_min(vf_max(vf_sub(v_half, d), v_zero), v_one), v_alpha);
+        blend_pixels(row + x, coverage, color);
+    }
+
+    for(; x < x1; ++x)
+        blend_pixel(row + x, box_coverage(s, (float)x + .5f, qy) * color->alpha, color);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void raster_box(const ui_raster_region* region, const ui_command* cmd)
+{
+    ui_box_shape s =
+    {
+        .bx = cmd->data.box.width * .5f,
+        .by = cmd->data.box.height * .5f,
+        .cx = cmd->data.box.x + cmd->data.box.width * .5f,
+        .cy = cmd->data.box.y + cmd->data.box.height * .5f
+    };
+    s.radius = fmaxf(fminf(cmd->data.box.radius, fminf(s.bx, s.by)), 0.f);
+
+    ui_raster_color color = unpack_color(cmd->srgb_color);
+    const bool opaque = (cmd->srgb_color >> 24) == 0xFF;
+
+    // pixels fully covered on the straight part of the box
+    int32_t inner_x0 = (int32_t) ceilf(s.cx - s.bx);
+    int32_t inner_x1 = (int32_t) floorf(s.cx + s.bx);
+    inner_x0 = (inner_x0 < region->min_x) ? region->min_x : (inner_x0 > region->max_x) ? region->max_x : inner_x0;
+    inner_x1 = (inner_x1 > region->max_x) ? region->max_x : (inner_x1 < inner_x0) ? inner_x0 : inner_x1;
+
+    for(int32_t y=region->min_y; y<region->max_y; ++y)
+    {
+        uint32_t* row = region->pixels + (size_t)y * region->stride;
+        float py = (float)y + .5f;
+
+        if (opaque && fabsf(py - s.cy) <= s.by - fmaxf(s.radius, .5f) && inner_x1 > inner_x0)
+        {
+            box_span(row, region->min_x, inner_x0, py, &s, &color);
+            for(int32_t x=inner_x0; x<inner_x1; ++x)
+                row[x] = cmd->srgb_color;
+            box_span(row, inner_x1, region->max_x, py, &s, &color);
+        }
+        else
+            box_span(row, region->min_x, region->max_x, py, &s, &color);
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// capsule between the two points
+static void raster_line(const ui_raster_region* region, const ui_command* cmd)
+{
+    float ax = cmd->data.line.x0, ay = cmd->data.line.y0;
+    float bax = cmd->data.line.x1 - ax, bay = cmd->data.line.y1 - ay;
+    float inv_length2 = 1.f / fmaxf(bax * bax + bay * bay, 1e-6f);
+    float half_width = cmd->data.line.width * .5f;
+    ui_raster_color color = unpack_color(cmd->srgb_color);
+
+    vfloat v_ax = vf_set1(ax), v_bax = vf_set1(bax), v_bay = vf_set1(bay), v_inv_length2 = vf_set1(inv_length2);
+    vfloat v_half_width = vf_set1(half_width), v_alpha = vf_set1(color.alpha);
+    vfloat v_half = vf_set1(.5f), v_zero = vf_set1(0.f), v_one = vf_set1(1.f);
+
+    for(int32_t y=region->min_y; y<region->max_y; ++y)
+    {
+        uint32_t* row = region->pixels + (size_t)y * region->stride;
+        float pay = (float)y + .5f - ay;
+        vfloat v_pay = vf_set1(pay);
+        int32_t x = region->min_x;
+
+        for(; x + SIMD_LANES <= region->max_x; x += SIMD_LANES)
+        {
+            vfloat pax = vf_sub(vf_ramp((float)x + .5f), v_ax);
+            vfloat h = vf_mul(vf_add(vf_mul(pax, v_bax), vf_mul(v_pay, v_bay)), v_inv_length2);
+            h = vf_min(vf_max(h, v_zero), v_one);
+            vfloat dx = vf_sub(pax, vf_mul(v_bax, h));
+            vfloat dy = vf_sub(v_pay, vf_mul(v_bay, h));
+            vfloat d = vf_sub(vf_sqrt(vf_add(vf_mul(dx, dx), vf_mul(dy, dy))), v_half_width);
+            vfloat coverage = vf_mul(vf_min(vf_max(vf_sub(v_half, d), v_zero), v_one), v_alpha);
+            blend_pixels(row + x, coverage, &color);
+        }
+
+        for(; x < region->max_x; ++x)
+        {
+            float pax = (float)x + .5f - ax;
+            float h = fminf(fmaxf((pax * bax + pay * bay) * inv_length2, 0.f), 1.f);
+            float dx = pax - bax * h, dy = pay - bay * h;
+            float d = sqrtf(dx * dx + dy * dy) - half_width;
+            blend_pixel(row + x, clamp_coverage(.5f - d) * color.alpha, &color);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Binning
+//-----------------------------------------------------------------------------------------------------------------------------
+
+static inline int32_t min_int(int32_t a, int32_t b) {return (a < b) ? a : b;}
+static inline int32_t max_int(int32_t a, int32_t b) {return (a > b) ? a : b;}
+
+static inline ui_irect intersect(ui_irect a, ui_irect b)
+{
+    return (ui_irect) {max_int(a.min_x, b.min_x), max_int(a.min_y, b.min_y), min_int(a.max_x, b.max_x), min_int(a.max_y, b.max_y)};
+}
+
+// range of tiles overlapped by non-empty bounds, max excluded
+static inline ui_irect tile_range(ui_irect bounds)
+{
+    return (ui_irect) {bounds.min_x / TILE_SIZE, bounds.min_y / TILE_SIZE,
+                       (bounds.max_x + TILE_SIZE - 1) / TILE_SIZE, (bounds.max_y + TILE_SIZE - 1) / TILE_SIZE};
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// pixel bounds of each command, clipped by the clip rect active at that time, then the command indices are binned per
+// tile (count, prefix sum, fill). Returns the number of commands binned : the batch stops when the bins are full
+static uint32_t compute_bounds(ui_raster* r, const ui_command* commands, uint32_t count)
+{
+    uint32_t num_tiles = r->tiles_x * r->tiles_y;
+    uint32_t num_entries = 0;
+    memset(r->tile_first, 0, sizeof(uint32_t) * (num_tiles + 1));
+
+    uint32_t i = 0;
+    for(; i<count; ++i)
+    {
+        const ui_command* cmd = &commands[i];
+        ui_irect bounds = {0, 0, 0, 0};
+
+        switch(cmd->type)
+        {
+        case command_clip_rect:
+            r->clip = (ui_irect) {cmd->data.clip_rect.min_x, cmd->data.clip_rect.min_y, cmd->data.clip_rect.max_x, cmd->data.clip_rect.max_y};
+            r->clip = intersect(r->clip, (ui_irect) {0, 0, (int32_t)r->def.width, (int32_t)r->def.height});
+            break;
+        case command_box:
+            bounds = (ui_irect)
+            {
+                (int32_t) floorf(cmd->data.box.x), (int32_t) floorf(cmd->data.box.y),
+                (int32_t) ceilf(cmd->data.box.x + cmd->data.box.width), (int32_t) ceilf(cmd->data.box.y + cmd->data.box.height)
+            };
+            break;
+        case command_line:
+        {
+            float extent = cmd->data.line.width * .5f + 1.f;
+            bounds = (ui_irect)
+            {
+                (int32_t) floorf(fminf(cmd->data.line.x0, cmd->data.line.x1) - extent),
+                (int32_t) floorf(fminf(cmd->data.line.y0, cmd->data.line.y1) - extent),
+                (int32_t) ceilf(fmaxf(cmd->data.line.x0, cmd->data.line.x1) + extent),
+                (int32_t) ceilf(fmaxf(cmd->data.line.y0, cmd->data.line.y1) + extent)
+            };
+            break;
+        }
+        case command_text:
+            bounds = r->clip;   // size of the text is unknown, the callback will clip
+            break;
+        }
+
+        bounds = intersect(bounds, r->clip);
+        if (bounds.min_x >= bounds.max_x || bounds.min_y >= bounds.max_y)
+            bounds = (ui_irect) {0, 0, 0, 0};
+
+        // a clip rect has empty bounds and can't fill the bins : the clip state is right when the batch stops
+        ui_irect tiles = tile_range(bounds);
+        uint32_t entries = (uint32_t) ((tiles.max_x - tiles.min_x) * (tiles.max_y - tiles.min_y));
+        if (num_entries + entries > r->max_tile_commands)
+            break;
+
+        num_entries += entries;
+        r->bounds[i] = bounds;
+        for(int32_t ty=tiles.min_y; ty<tiles.max_y; ++ty)
+            for(int32_t tx=tiles.min_x; tx<tiles.max_x; ++tx)
+                r->tile_first[ty * (int32_t)r->tiles_x + tx + 1]++;
+    }
+
+    for(uint32_t t=0; t<num_tiles; ++t)
+    {
+        r->tile_first[t + 1] += r->tile_first[t];
+        r->tile_cursor[t] = r->tile_first[t];
+    }
+
+    // commands are appended in order, each tile draws them in the order they were issued
+    for(uint32_t c=0; c<i; ++c)
+    {
+        ui_irect tiles = tile_range(r->bounds[c]);
+        for(int32_t ty=tiles.min_y; ty<tiles.max_y; ++ty)
+            for(int32_t tx=tiles.min_x; tx<tiles.max_x; ++tx)
+                r->tile_commands[r->tile_cursor[ty * (int32_t)r->tiles_x + tx]++] = c;
+    }
+    return i;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void raster_tile(void* data, uint32_t index)
+{
+    ui_raster* r = (ui_raster*) data;
+    int32_t tile_x = (int32_t)(index % r->tiles_x) * TILE_SIZE;
+    int32_t tile_y = (int32_t)(index / r->tiles_x) * TILE_SIZE;
+    ui_irect tile = {tile_x, tile_y, min_int(tile_x + TILE_SIZE, (int32_t)r->def.width), min_int(tile_y + TILE_SIZE, (int32_t)r->def.height)};
+
+    for(uint32_t j=r->tile_first[index]; j<r->tile_first[index + 1]; ++j)
+    {
+        uint32_t i = r->tile_commands[j];
+        ui_irect area = intersect(r->bounds[i], tile);
+        if (area.min_x >= area.max_x || area.min_y >= area.max_y)
+            continue;
+
+        ui_raster_region region = {r->def.pixels, r->def.stride, area.min_x, area.min_y, area.max_x, area.max_y};
+        const ui_command* cmd = &r->batch[i];
+
+        switch(cmd->type)
+        {
+        case command_box: raster_box(&region, cmd); break;
+        case command_line: raster_line(&region, cmd); break;
+        case command_text:
+            if (r->def.draw_text != NULL)
+                r->def.draw_text(&region, cmd->data.text.x, cmd->data.text.y, cmd->data.text.text, cmd->srgb_color, r->def.user);
+            break;
+        case command_clip_rect: break;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void raster_batches(ui_raster* r, const ui_command* commands, uint32_t num_commands)
+{
+    // bounds and bins are stored per command, big arrays or arrays of big commands are processed in batches
+    for(uint32_t first=0; first<num_commands; first+=r->batch_size)
+    {
+        r->batch = commands + first;
+        r->batch_size = compute_bounds(r, r->batch, (uint32_t) min_int((int32_t)(num_commands - first), (int32_t)r->def.max_commands));
+
+        uint32_t num_tiles = r->tiles_x * r->tiles_y;
+        if (r->def.parallel_for != NULL)
+            r->def.parallel_for(raster_tile, r, num_tiles, r->def.user);
+        else
+            for(uint32_t i=0; i<num_tiles; ++i)
+                raster_tile(r, i);
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Renderer callbacks
+//-----------------------------------------------------------------------------------------------------------------------------
+
+static inline ui_command* record(ui_raster* r, enum ui_command_type type, uint32_t srgb_color)
+{
+    // the recording is full, rasterize what we have
+    if (r->num_commands >= r->def.max_commands)
+        ui_raster_flush(r);
+
+    ui_command* cmd = &r->commands[r->num_commands++];
+    cmd->type = type;
+    cmd->srgb_color = srgb_color;
+    return cmd;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void raster_draw_box(float x, float y, float width, float height, float radius, uint32_t srgb_color, void* user)
+{
+    ui_command* cmd = record((ui_raster*) user, command_box, srgb_color);
+    cmd->data.box.x = x; cmd->data.box.y = y;
+    cmd->data.box.width = width; cmd->data.box.height = height;
+    cmd->data.box.radius = radius;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void raster_draw_text(float x, float y, const char* text, uint32_t srgb_color, void* user)
+{
+    ui_raster* r = (ui_raster*) user;
+    size_t length = strlen(text);
+    if (length + 1 > r->def.text_buffer_size)
+        return;
+
+    if (r->text_offset + length + 1 > r->def.text_buffer_size)
+        ui_raster_flush(r);
+
+    char* copy = r->text_buffer + r->text_offset;
+    memcpy(copy, text, length + 1);
+    r->text_offset += (uint32_t)length + 1;
+
+    ui_command* cmd = record(r, command_text, srgb_color);
+    cmd->data.text.x = x; cmd->data.text.y = y;
+    cmd->data.text.text = copy;
+    cmd->data.text.length = (uint32_t) length;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void raster_draw_line(float x0, float y0, float x1, float y1, float width, uint32_t srgb_color, void* user)
+{
+    ui_command* cmd = record((ui_raster*) user, command_line, srgb_color);
+    cmd->data.line.x0 = x0; cmd->data.line.y0 = y0;
+    cmd->data.line.x1 = x1; cmd->data.line.y1 = y1;
+    cmd->data.line.width = width;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void raster_set_clip_rect(uint16_t min_x, uint16_t min_y, uint16_t max_x, uint16_t max_y, void* user)
+{
+    ui_command* cmd = record((ui_raster*) user, command_clip_rect, 0);
+    cmd->data.clip_rect.min_x = min_x; cmd->data.clip_rect.min_y = min_y;
+    cmd->data.clip_rect.max_x = max_x; cmd->data.clip_rect.max_y = max_y;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static float raster_text_width(const char* text, void* user)
+{
+    ui_raster* r = (ui_raster*) user;
+    return r->def.text_width(text, r->def.user);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Public functions
+//-----------------------------------------------------------------------------------------------------------------------------
+
+static inline size_t align8(size_t size) {return (size + 7) & ~(size_t)7;}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// the bins hold at least one command covering the whole screen, the batches always make progress
+static inline uint32_t bin_capacity(const ui_raster_def* def, uint32_t num_tiles)
+{
+    return (uint32_t) max_int((int32_t)num_tiles, (int32_t)(def->max_commands * TILE_ENTRIES_PER_COMMAND));
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline uint32_t tile_count(const ui_raster_def* def)
+{
+    return ((def->width + TILE_SIZE - 1) / TILE_SIZE) * ((def->height + TILE_SIZE - 1) / TILE_SIZE);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+size_t ui_raster_min_memory_size(const ui_raster_def* def)
+{
+    uint32_t tiles = tile_count(def);
+    return align8(sizeof(ui_raster)) + align8(sizeof(ui_command) * def->max_commands) +
+           align8(sizeof(ui_irect) * def->max_commands) + align8(sizeof(uint32_t) * (tiles + 1)) +
+           align8(sizeof(uint32_t) * tiles) + align8(sizeof(uint32_t) * bin_capacity(def, tiles)) +
+           def->text_buffer_size;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+ui_raster* ui_raster_init(const ui_raster_def* def)
+{
+    assert(((uintptr_t)def->preallocated_buffer)%sizeof(uintptr_t) == 0);
+    assert(def->pixels != NULL && def->stride >= def->width && def->text_width != NULL);
+    assert(def->max_commands > 0);
+
+    uint8_t* buffer = (uint8_t*) def->preallocated_buffer;
+    ui_raster* r = (ui_raster*) buffer;
+    buffer += align8(sizeof(ui_raster));
+
+    *r = (ui_raster)
+    {
+        .def = *def,
+        .commands = (ui_command*) buffer,
+        .bounds = (ui_irect*) (buffer + align8(sizeof(ui_command) * def->max_commands)),
+        .tiles_x = (def->width + TILE_SIZE - 1) / TILE_SIZE,
+        .tiles_y = (def->height + TILE_SIZE - 1) / TILE_SIZE,
+        .clip = {0, 0, (int32_t)def->width, (int32_t)def->height}
+    };
+    buffer = (uint8_t*) r->bounds + align8(sizeof(ui_irect) * def->max_commands);
+
+    uint32_t tiles = tile_count(def);
+    r->max_tile_commands = bin_capacity(def, tiles);
+    r->tile_first = (uint32_t*) buffer;
+    buffer += align8(sizeof(uint32_t) * (tiles + 1));
+    r->tile_cursor = (uint32_t*) buffer;
+    buffer += align8(sizeof(uint32_t) * tiles);
+    r->tile_commands = (uint32_t*) buffer;
+    buffer += align8(sizeof(uint32_t) * r->max_tile_commands);
+    r->text_buffer = (char*) buffer;
+    return r;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+ui_renderer_fnc_t ui_raster_renderer(ui_raster* raster)
+{
+    return (ui_renderer_fnc_t)
+    {
+        .draw_box = raster_draw_box,
+        .draw_text = raster_draw_text,
+        .draw_line = raster_draw_line,
+        .set_clip_rect = raster_set_clip_rect,
+        .text_width = raster_text_width,
+        .user = raster
+    };
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_raster_clear(ui_raster* raster, uint32_t srgb_color)
+{
+    for(uint32_t y=0; y<raster->def.height; ++y)
+    {
+        uint32_t* row = raster->def.pixels + (size_t)y * raster->def.stride;
+        for(uint32_t x=0; x<raster->def.width; ++x)
+            row[x] = srgb_color;
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_raster_commands(ui_raster* raster, const ui_command* commands, uint32_t num_commands)
+{
+    raster->clip = (ui_irect) {0, 0, (int32_t)raster->def.width, (int32_t)raster->def.height};
+    raster_batches(raster, commands, num_commands);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// the clip rect is not reset, the recording could have been flushed in the middle of a window
+void ui_raster_flush(ui_raster* raster)
+{
+    raster_batches(raster, raster->commands, raster->num_commands);
+    raster->num_commands = 0;
+    raster->text_offset = 0;
+}
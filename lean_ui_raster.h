@@ -0,0 +1,74 @@
+#ifndef __LEAN_UI_RASTER_H__
+#define __LEAN_UI_RASTER_H__
+
+#include "lean_ui.h"
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Optional module : software renderer on a RGBA8 framebuffer, for headless or GPU-less targets
+// Draw calls are recorded then rasterized per tile at ui_raster_flush(), tiles can be processed by a job system.
+//-----------------------------------------------------------------------------------------------------------------------------
+
+typedef struct
+{
+    uint32_t* pixels;                       // first pixel of the framebuffer
+    uint32_t stride;                        // in pixels
+    int32_t min_x, min_y, max_x, max_y;     // writable area, max excluded
+} ui_raster_region;
+
+typedef struct
+{
+    void* preallocated_buffer;  // user-allocated memory of ui_raster_min_memory_size() bytes, must be aligned on 8 bytes
+    uint32_t max_commands;      // max number of draw calls between two flushes
+    uint32_t text_buffer_size;  // size in bytes to store the texts between two flushes
+
+    uint32_t* pixels;           // framebuffer, pixels use the same packing as colors (0xAABBGGRR)
+    uint32_t width, height;
+    uint32_t stride;            // in pixels
+
+    // optional, draws a text clipped to the region. Called from the tile jobs, must be thread-safe
+    void (*draw_text)(const ui_raster_region* region, float x, float y, const char* text, uint32_t srgb_color, void* user);
+
+    // forwarded to leanUI
+    float (*text_width)(const char* text, void* user);
+
+    // optional, runs job(data, index) for index in [0, count) and returns when all jobs are done
+    // if NULL tiles are processed on the calling thread
+    void (*parallel_for)(void (*job)(void* data, uint32_t index), void* data, uint32_t count, void* user);
+
+    void* user;
+} ui_raster_def;
+
+typedef struct ui_raster ui_raster;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the number of bytes needed for a rasterizer with these settings
+size_t ui_raster_min_memory_size(const ui_raster_def* def);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+ui_raster* ui_raster_init(const ui_raster_def* def);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the callbacks to put in ui_def.renderer_callbacks, the draw calls are recorded until ui_raster_flush()
+ui_renderer_fnc_t ui_raster_renderer(ui_raster* raster);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Fills the whole framebuffer with a color
+void ui_raster_clear(ui_raster* raster, uint32_t srgb_color);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Rasterizes the recorded draw calls and resets the recording
+void ui_raster_flush(ui_raster* raster);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Rasterizes an array of commands, see ui_get_commands() in deferred mode
+void ui_raster_commands(ui_raster* raster, const ui_command* commands, uint32_t num_commands);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,216 @@
+#include "lean_ui_replay.h"
+#include <string.h>
+#include <stdio.h>
+
+#define REPLAY_MAGIC (0x5255494Cu)     // "LUIR" in the file
+#define REPLAY_VERSION (1u)
+#define REPLAY_HEADER_SIZE (8)
+
+enum replay_event
+{
+    event_mouse_pos,        // float x, float y
+    event_mouse_button,     // uint8_t state
+    event_mouse_wheel,      // float delta
+    event_frame             // float delta_time, then ui_begin_frame()
+};
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Little-endian serialization, the stream does not depend on the host
+//-----------------------------------------------------------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline void store_u32(uint8_t* p, uint32_t value)
+{
+    p[0] = (uint8_t) value;
+    p[1] = (uint8_t) (value >> 8);
+    p[2] = (uint8_t) (value >> 16);
+    p[3] = (uint8_t) (value >> 24);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline uint32_t load_u32(const uint8_t* p)
+{
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline void store_float(uint8_t* p, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    store_u32(p, bits);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline float load_float(const uint8_t* p)
+{
+    uint32_t bits = load_u32(p);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns a pointer to the payload of the event or NULL if the buffer is full
+static uint8_t* write_event(ui_recorder* recorder, enum replay_event type, size_t payload_size)
+{
+    if (recorder->overflow || recorder->offset + 1 + payload_size > recorder->size)
+    {
+        recorder->overflow = true;
+        return NULL;
+    }
+
+    uint8_t* p = recorder->buffer + recorder->offset;
+    p[0] = (uint8_t) type;
+    recorder->offset += 1 + payload_size;
+    return p + 1;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Recorder
+//-----------------------------------------------------------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_recorder_init(ui_recorder* recorder, ui_context* ctx, void* buffer, size_t size)
+{
+    *recorder = (ui_recorder)
+    {
+        .ctx = ctx,
+        .buffer = (uint8_t*) buffer,
+        .size = size,
+        .offset = REPLAY_HEADER_SIZE,
+        .overflow = size < REPLAY_HEADER_SIZE
+    };
+
+    if (!recorder->overflow)
+    {
+        store_u32(recorder->buffer, REPLAY_MAGIC);
+        store_u32(recorder->buffer + 4, REPLAY_VERSION);
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_recorder_mouse_pos(ui_recorder* recorder, float x, float y)
+{
+    uint8_t* payload = write_event(recorder, event_mouse_pos, 8);
+    if (payload != NULL)
+    {
+        store_float(payload, x);
+        store_float(payload + 4, y);
+    }
+    ui_update_mouse_pos(recorder->ctx, x, y);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_recorder_mouse_button(ui_recorder* recorder, enum ui_button_state button)
+{
+    uint8_t* payload = write_event(recorder, event_mouse_button, 1);
+    if (payload != NULL)
+        payload[0] = (uint8_t) button;
+    ui_update_mouse_button(recorder->ctx, button);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_recorder_mouse_wheel(ui_recorder* recorder, float delta)
+{
+    uint8_t* payload = write_event(recorder, event_mouse_wheel, 4);
+    if (payload != NULL)
+        store_float(payload, delta);
+    ui_update_mouse_wheel(recorder->ctx, delta);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_recorder_begin_frame(ui_recorder* recorder, float delta_time)
+{
+    uint8_t* payload = write_event(recorder, event_frame, 4);
+    if (payload != NULL)
+        store_float(payload, delta_time);
+    ui_begin_frame(recorder->ctx, delta_time);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Replayer
+//-----------------------------------------------------------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------------------------------------------------------
+bool ui_replayer_init(ui_replayer* replayer, const void* data, size_t size)
+{
+    *replayer = (ui_replayer) {.data = (const uint8_t*) data, .size = size, .offset = REPLAY_HEADER_SIZE};
+    return size >= REPLAY_HEADER_SIZE && load_u32(replayer->data) == REPLAY_MAGIC && load_u32(replayer->data + 4) == REPLAY_VERSION;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+bool ui_replayer_next_frame(ui_replayer* replayer, ui_context* ctx, float fixed_delta_time)
+{
+    static const size_t payload_size[] = {8, 1, 4, 4};
+
+    while (replayer->offset < replayer->size)
+    {
+        const uint8_t* p = replayer->data + replayer->offset;
+        enum replay_event type = (enum replay_event) p[0];
+
+        // unknown event or truncated stream
+        if (type > event_frame || replayer->offset + 1 + payload_size[type] > replayer->size)
+            break;
+
+        replayer->offset += 1 + payload_size[type];
+        p++;
+
+        switch(type)
+        {
+        case event_mouse_pos: ui_update_mouse_pos(ctx, load_float(p), load_float(p + 4)); break;
+        case event_mouse_button: ui_update_mouse_button(ctx, (enum ui_button_state) p[0]); break;
+        case event_mouse_wheel: ui_update_mouse_wheel(ctx, load_float(p)); break;
+        case event_frame:
+            {
+                ui_begin_frame(ctx, (fixed_delta_time > 0.f) ? fixed_delta_time : load_float(p));
+                replayer->frame_index++;
+                return true;
+            }
+        }
+    }
+
+    replayer->offset = replayer->size;
+    return false;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Commands dump
+//-----------------------------------------------------------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------------------------------------------------------
+size_t ui_dump_commands(const ui_command* commands, uint32_t num_commands, char* buffer, size_t size)
+{
+    size_t length = 0;
+    for(uint32_t i=0; i<num_commands; ++i)
+    {
+        const ui_command* cmd = &commands[i];
+        char* output = (buffer != NULL && length < size) ? buffer + length : NULL;
+        size_t available = (output != NULL) ? size - length : 0;
+        int written = 0;
+
+        switch(cmd->type)
+        {
+        case command_box:
+            written = snprintf(output, available, "box %.2f %.2f %.2f %.2f %.2f %08x\n", cmd->data.box.x, cmd->data.box.y,
+                               cmd->data.box.width, cmd->data.box.height, cmd->data.box.radius, cmd->srgb_color);
+            break;
+        case command_text:
+            written = snprintf(output, available, "text %.2f %.2f %08x %.*s\n", cmd->data.text.x, cmd->data.text.y,
+                               cmd->srgb_color, (int) cmd->data.text.length, cmd->data.text.text);
+            break;
+        case command_line:
+            written = snprintf(output, available, "line %.2f %.2f %.2f %.2f %.2f %08x\n", cmd->data.line.x0, cmd->data.line.y0,
+                               cmd->data.line.x1, cmd->data.line.y1, cmd->data.line.width, cmd->srgb_color);
+            break;
+        case command_clip_rect:
+            written = snprintf(output, available, "clip %u %u %u %u\n", cmd->data.clip_rect.min_x, cmd->data.clip_rect.min_y,
+                               cmd->data.clip_rect.max_x, cmd->data.clip_rect.max_y);
+            break;
+        }
+
+        if (written > 0)
+            length += (size_t) written;
+    }
+    return length;
+}
@@ -0,0 +1,70 @@
+#ifndef __LEAN_UI_REPLAY_H__
+#define __LEAN_UI_REPLAY_H__
+
+#include "lean_ui.h"
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Optional module : records the input stream of a context (mouse and delta time per frame) in a compact binary format
+// and replays it headless with a fixed timestep. Recorded sessions become repeatable workloads, the commands emitted
+// in deferred mode can be dumped as text and diffed between two versions.
+//
+// The stream is a header followed by events, each event is a type byte and its payload (little-endian floats).
+// The buffers are user-allocated, save them to a file with fwrite() and load them with fread().
+//-----------------------------------------------------------------------------------------------------------------------------
+
+typedef struct
+{
+    ui_context* ctx;            // the inputs are forwarded to this context
+    uint8_t* buffer;            // user-allocated
+    size_t size;
+    size_t offset;              // number of bytes recorded
+    bool overflow;              // true if some events did not fit in the buffer
+} ui_recorder;
+
+typedef struct
+{
+    const uint8_t* data;
+    size_t size;
+    size_t offset;
+    uint32_t frame_index;       // number of frames replayed
+} ui_replayer;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Starts a recording, writes the header of the stream in [buffer]
+void ui_recorder_init(ui_recorder* recorder, ui_context* ctx, void* buffer, size_t size);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Same as the ui_update_* functions and ui_begin_frame(), the input is recorded then forwarded to the context
+void ui_recorder_mouse_pos(ui_recorder* recorder, float x, float y);
+void ui_recorder_mouse_button(ui_recorder* recorder, enum ui_button_state button);
+void ui_recorder_mouse_wheel(ui_recorder* recorder, float delta);
+void ui_recorder_begin_frame(ui_recorder* recorder, float delta_time);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns false if the data is not a stream recorded by ui_recorder
+bool ui_replayer_init(ui_replayer* replayer, const void* data, size_t size);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Sends the inputs of the next recorded frame to the context and calls ui_begin_frame()
+// then build the ui as usual and call ui_end_frame()
+//      [fixed_delta_time]  if > 0.f replaces the recorded delta time, makes the replay deterministic
+//
+// returns false when the end of the stream is reached, ui_begin_frame() is not called
+bool ui_replayer_next_frame(ui_replayer* replayer, ui_context* ctx, float fixed_delta_time);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Writes the commands as text, one command per line, to diff two command streams
+//      [buffer]    can be NULL to get the size needed
+//
+// returns the number of characters needed (excluding the null terminator), the output is truncated if size is too small
+size_t ui_dump_commands(const ui_command* commands, uint32_t num_commands, char* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,475 @@
+#include "lean_ui_text.h"
+#include <assert.h>
+#include <string.h>
+
+#define RUN_WAYS (4)
+#define RUN_BYTES_PER_GLYPH (4)     // size of the pool of the cached strings, per glyph of max_run_glyphs
+#define GLYPH_PADDING (1)
+#define EMPTY_SLOT (UINT32_MAX)
+
+typedef struct
+{
+    uint32_t codepoint;         // EMPTY_SLOT if the slot is free
+    uint16_t x, y, width, height;
+    float offset_x, offset_y;
+    float advance;
+} text_glyph;
+
+typedef struct
+{
+    float x0, y0, x1, y1;       // relative to the position of the text
+    float u0, v0, u1, v1;
+} run_quad;
+
+typedef struct
+{
+    uint32_t hash;
+    uint32_t length;            // 0 if the entry is free
+    uint32_t first_byte;        // the string in run_strings, compared on a hash match
+    uint32_t first_quad;
+    uint32_t num_quads;
+    uint32_t last_frame;
+    float width;
+} text_run;
+
+struct ui_text_cache
+{
+    ui_text_def def;
+    uint8_t* atlas;
+    text_glyph* glyphs;         // open addressing, the table is twice as large as max_glyphs
+    uint32_t glyph_table_size;
+    uint32_t num_glyphs;
+    text_run* runs;             // set-associative, RUN_WAYS entries per set
+    uint32_t num_sets;
+    run_quad* run_quads;        // quads of the cached runs, cleared when full
+    uint32_t num_run_quads;
+    char* run_strings;          // strings of the cached runs, cleared with the quads
+    uint32_t num_run_bytes;
+    ui_text_quad* quads;        // output of the frame
+    uint32_t num_quads;
+    uint32_t shelf_x, shelf_y, shelf_height;
+    uint32_t frame_index;
+    uint32_t hits, misses;
+    bool atlas_dirty;
+    bool atlas_full;
+};
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline size_t align8(size_t size) {return (size + 7) & ~(size_t)7;}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static inline uint32_t next_power_of_two(uint32_t value)
+{
+    uint32_t result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// returns the codepoint and moves the pointer to the next one, invalid sequences return U+FFFD
+static inline uint32_t decode_utf8(const uint8_t** p)
+{
+    const uint8_t* s = *p;
+    uint32_t c = s[0];
+    uint32_t length = (c < 0x80) ? 1 : ((c >> 5) == 0x6) ? 2 : ((c >> 4) == 0xE) ? 3 : ((c >> 3) == 0x1E) ? 4 : 0;
+
+    if (length == 0)
+    {
+        *p = s + 1;
+        return 0xFFFD;
+    }
+
+    c &= 0xFF >> (length + (length > 1));
+    for(uint32_t i=1; i<length; ++i)
+    {
+        if ((s[i] & 0xC0) != 0x80)
+        {
+            *p = s + 1;
+            return 0xFFFD;
+        }
+        c = (c << 6) | (s[i] & 0x3F);
+    }
+
+    *p = s + length;
+    return c;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Glyphs
+//-----------------------------------------------------------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static bool bitmap_metrics(const ui_bitmap_font* font, uint32_t codepoint, ui_glyph_metrics* metrics)
+{
+    if (codepoint < font->first_char || codepoint >= font->first_char + font->num_chars)
+        return false;
+
+    *metrics = (ui_glyph_metrics)
+    {
+        .width = (float) font->cell_width,
+        .height = (float) font->cell_height,
+        .advance = (float) font->cell_width
+    };
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void bitmap_rasterize(const ui_bitmap_font* font, uint32_t codepoint, uint8_t* pixels, uint32_t stride)
+{
+    uint32_t index = codepoint - font->first_char;
+    const uint8_t* cell = font->pixels + (index / font->columns) * font->cell_height * font->stride +
+                          (index % font->columns) * font->cell_width;
+
+    for(uint32_t y=0; y<font->cell_height; ++y)
+        memcpy(pixels + y * stride, cell + y * font->stride, font->cell_width);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// shelf packing, returns false if the atlas is full
+static bool pack_glyph(ui_text_cache* text, uint32_t width, uint32_t height, uint16_t* x, uint16_t* y)
+{
+    if (text->shelf_x + width + GLYPH_PADDING > text->def.atlas_width)
+    {
+        text->shelf_y += text->shelf_height;
+        text->shelf_x = 0;
+        text->shelf_height = 0;
+    }
+
+    if (width + GLYPH_PADDING > text->def.atlas_width || text->shelf_y + height + GLYPH_PADDING > text->def.atlas_height)
+        return false;
+
+    *x = (uint16_t) text->shelf_x;
+    *y = (uint16_t) text->shelf_y;
+    text->shelf_x += width + GLYPH_PADDING;
+    if (height + GLYPH_PADDING > text->shelf_height)
+        text->shelf_height = height + GLYPH_PADDING;
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the glyph of the codepoint, rasterizes it in the atlas the first time. Missing glyphs are stored without
+// bitmap and advance, returns NULL if the glyph could not be added.
+static const text_glyph* get_glyph(ui_text_cache* text, uint32_t codepoint)
+{
+    uint32_t mask = text->glyph_table_size - 1;
+    uint32_t slot = (codepoint * 0x9E3779B1u) & mask;
+    while (text->glyphs[slot].codepoint != EMPTY_SLOT)
+    {
+        if (text->glyphs[slot].codepoint == codepoint)
+            return &text->glyphs[slot];
+        slot = (slot + 1) & mask;
+    }
+
+    if (text->num_glyphs >= text->def.max_glyphs)
+    {
+        text->atlas_full = true;
+        return NULL;
+    }
+
+    ui_glyph_metrics metrics = {0};
+    bool exists = (text->def.bitmap_font != NULL) ? bitmap_metrics(text->def.bitmap_font, codepoint, &metrics) :
+                                                    text->def.glyph_metrics(codepoint, &metrics, text->def.user);
+
+    text_glyph glyph = {.codepoint = codepoint};
+    if (exists)
+    {
+        glyph.width = (uint16_t) metrics.width;
+        glyph.height = (uint16_t) metrics.height;
+        glyph.offset_x = metrics.offset_x;
+        glyph.offset_y = metrics.offset_y;
+        glyph.advance = metrics.advance;
+
+        if (glyph.width > 0 && glyph.height > 0)
+        {
+            if (!pack_glyph(text, glyph.width, glyph.height, &glyph.x, &glyph.y))
+            {
+                text->atlas_full = true;
+                return NULL;
+            }
+
+            uint8_t* pixels = text->atlas + glyph.y * text->def.atlas_width + glyph.x;
+            if (text->def.bitmap_font != NULL)
+                bitmap_rasterize(text->def.bitmap_font, codepoint, pixels, text->def.atlas_width);
+            else
+                text->def.rasterize_glyph(codepoint, pixels, text->def.atlas_width, text->def.user);
+            text->atlas_dirty = true;
+        }
+    }
+
+    text->num_glyphs++;
+    text->glyphs[slot] = glyph;
+    return &text->glyphs[slot];
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Text runs
+//-----------------------------------------------------------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void clear_runs(ui_text_cache* text)
+{
+    for(uint32_t i=0; i<text->num_sets * RUN_WAYS; ++i)
+        text->runs[i].length = 0;
+    text->num_run_quads = 0;
+    text->num_run_bytes = 0;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// lays out the glyphs of the string in the run, returns false if the quads of the runs cache are full, the run
+// then contains only the glyphs that fit but its width is right
+static bool layout_run(ui_text_cache* text, text_run* run, const char* string)
+{
+    const uint8_t* p = (const uint8_t*) string;
+    const float inv_width = 1.f / (float) text->def.atlas_width;
+    const float inv_height = 1.f / (float) text->def.atlas_height;
+    uint32_t previous = 0;
+    float pen = 0.f;
+    bool fit = true;
+
+    run->first_quad = text->num_run_quads;
+    run->num_quads = 0;
+
+    while (*p != 0)
+    {
+        uint32_t codepoint = decode_utf8(&p);
+        const text_glyph* glyph = get_glyph(text, codepoint);
+        if (glyph == NULL)
+            continue;
+
+        if (previous != 0 && text->def.kerning != NULL)
+            pen += text->def.kerning(previous, codepoint, text->def.user);
+        previous = codepoint;
+
+        if (glyph->width > 0 && text->num_run_quads >= text->def.max_run_glyphs)
+            fit = false;
+        else if (glyph->width > 0)
+        {
+            text->run_quads[text->num_run_quads++] = (run_quad)
+            {
+                .x0 = pen + glyph->offset_x,
+                .y0 = glyph->offset_y,
+                .x1 = pen + glyph->offset_x + glyph->width,
+                .y1 = glyph->offset_y + glyph->height,
+                .u0 = glyph->x * inv_width,
+                .v0 = glyph->y * inv_height,
+                .u1 = (glyph->x + glyph->width) * inv_width,
+                .v1 = (glyph->y + glyph->height) * inv_height
+            };
+            run->num_quads++;
+        }
+        pen += glyph->advance;
+    }
+
+    run->width = pen;
+    return fit;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the cached run of the string, the runs are identified by the hash and the length of the string then by the
+// content, two strings with the same hash do not share their run
+static const text_run* get_run(ui_text_cache* text, const char* string)
+{
+    uint32_t hash = 0x811c9dc5;
+    uint32_t length = 0;
+    for(const uint8_t* p = (const uint8_t*) string; *p != 0; ++p, ++length)
+    {
+        hash ^= *p;
+        hash *= 0x01000193;
+    }
+
+    text_run* set = &text->runs[(hash & (text->num_sets - 1)) * RUN_WAYS];
+    text_run* oldest = &set[0];
+    for(uint32_t i=0; i<RUN_WAYS; ++i)
+    {
+        text_run* run = &set[i];
+        if (run->length == length + 1 && run->hash == hash && memcmp(text->run_strings + run->first_byte, string, length) == 0)
+        {
+            run->last_frame = text->frame_index;
+            text->hits++;
+            return run;
+        }
+
+        if (run->length == 0 || (oldest->length != 0 && run->last_frame < oldest->last_frame))
+            oldest = run;
+    }
+
+    // the length is stored + 1 to keep 0 for the free entries
+    text->misses++;
+    const uint32_t run_bytes_size = text->def.max_run_glyphs * RUN_BYTES_PER_GLYPH;
+    *oldest = (text_run) {.hash = hash, .length = length + 1, .last_frame = text->frame_index};
+    if (text->num_run_bytes + length > run_bytes_size || !layout_run(text, oldest, string))
+    {
+        // no more room for the string or the quads : restart with an empty cache
+        clear_runs(text);
+        *oldest = (text_run) {.hash = hash, .length = length + 1, .last_frame = text->frame_index};
+        layout_run(text, oldest, string);
+    }
+
+    // a string longer than the whole pool is laid out but not cached
+    if (length <= run_bytes_size - text->num_run_bytes)
+    {
+        oldest->first_byte = text->num_run_bytes;
+        memcpy(text->run_strings + text->num_run_bytes, string, length);
+        text->num_run_bytes += length;
+    }
+    else
+        oldest->length = 0;
+    return oldest;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Callbacks
+//-----------------------------------------------------------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void text_draw_callback(float x, float y, const char* string, uint32_t srgb_color, void* user)
+{
+    ui_text_draw((ui_text_cache*) user, x, y, string, srgb_color);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static float text_width_callback(const char* string, void* user)
+{
+    return ui_text_width((ui_text_cache*) user, string);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Public functions
+//-----------------------------------------------------------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------------------------------------------------------
+size_t ui_text_min_memory_size(const ui_text_def* def)
+{
+    uint32_t num_sets = next_power_of_two((def->max_runs + RUN_WAYS - 1) / RUN_WAYS);
+    return align8(sizeof(ui_text_cache)) + align8((size_t) def->atlas_width * def->atlas_height) +
+           align8(sizeof(text_glyph) * next_power_of_two(def->max_glyphs * 2)) +
+           align8(sizeof(text_run) * num_sets * RUN_WAYS) + align8(sizeof(run_quad) * def->max_run_glyphs) +
+           align8((size_t) def->max_run_glyphs * RUN_BYTES_PER_GLYPH) +
+           sizeof(ui_text_quad) * def->max_quads;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+ui_text_cache* ui_text_init(const ui_text_def* def)
+{
+    assert(((uintptr_t)def->preallocated_buffer)%sizeof(uintptr_t) == 0);
+    assert(def->bitmap_font != NULL || (def->glyph_metrics != NULL && def->rasterize_glyph != NULL));
+    assert(def->atlas_width > 0 && def->atlas_width <= UINT16_MAX && def->atlas_height > 0 && def->atlas_height <= UINT16_MAX);
+    assert(def->max_glyphs > 0 && def->max_runs > 0);
+
+    uint8_t* buffer = (uint8_t*) def->preallocated_buffer;
+    ui_text_cache* text = (ui_text_cache*) buffer;
+    buffer += align8(sizeof(ui_text_cache));
+
+    *text = (ui_text_cache)
+    {
+        .def = *def,
+        .glyph_table_size = next_power_of_two(def->max_glyphs * 2),
+        .num_sets = next_power_of_two((def->max_runs + RUN_WAYS - 1) / RUN_WAYS)
+    };
+
+    text->atlas = buffer;
+    buffer += align8((size_t) def->atlas_width * def->atlas_height);
+    text->glyphs = (text_glyph*) buffer;
+    buffer += align8(sizeof(text_glyph) * text->glyph_table_size);
+    text->runs = (text_run*) buffer;
+    buffer += align8(sizeof(text_run) * text->num_sets * RUN_WAYS);
+    text->run_quads = (run_quad*) buffer;
+    buffer += align8(sizeof(run_quad) * def->max_run_glyphs);
+    text->run_strings = (char*) buffer;
+    buffer += align8((size_t) def->max_run_glyphs * RUN_BYTES_PER_GLYPH);
+    text->quads = (ui_text_quad*) buffer;
+
+    // forces the clear of the atlas and caches
+    text->atlas_full = true;
+    ui_text_begin_frame(text);
+    return text;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+ui_renderer_fnc_t ui_text_renderer(ui_text_cache* text)
+{
+    return (ui_renderer_fnc_t)
+    {
+        .draw_text = text_draw_callback,
+        .text_width = text_width_callback,
+        .user = text
+    };
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_text_begin_frame(ui_text_cache* text)
+{
+    text->num_quads = 0;
+    text->frame_index++;
+
+    if (text->atlas_full)
+    {
+        memset(text->atlas, 0, (size_t) text->def.atlas_width * text->def.atlas_height);
+        for(uint32_t i=0; i<text->glyph_table_size; ++i)
+            text->glyphs[i].codepoint = EMPTY_SLOT;
+
+        text->num_glyphs = 0;
+        text->shelf_x = text->shelf_y = text->shelf_height = 0;
+        text->atlas_full = false;
+        text->atlas_dirty = true;
+        clear_runs(text);
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+float ui_text_width(ui_text_cache* text, const char* string)
+{
+    return get_run(text, string)->width;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_text_draw(ui_text_cache* text, float x, float y, const char* string, uint32_t srgb_color)
+{
+    const text_run* run = get_run(text, string);
+    if (text->num_quads + run->num_quads > text->def.max_quads)
+    {
+        assert(!"ui_text_def.max_quads is too small");
+        return;
+    }
+
+    const run_quad* input = &text->run_quads[run->first_quad];
+    ui_text_quad* output = &text->quads[text->num_quads];
+    for(uint32_t i=0; i<run->num_quads; ++i)
+    {
+        output[i] = (ui_text_quad)
+        {
+            .x0 = x + input[i].x0, .y0 = y + input[i].y0,
+            .x1 = x + input[i].x1, .y1 = y + input[i].y1,
+            .u0 = input[i].u0, .v0 = input[i].v0,
+            .u1 = input[i].u1, .v1 = input[i].v1,
+            .srgb_color = srgb_color
+        };
+    }
+    text->num_quads += run->num_quads;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+const ui_text_quad* ui_text_get_quads(const ui_text_cache* text, uint32_t* num_quads)
+{
+    *num_quads = text->num_quads;
+    return text->quads;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+const uint8_t* ui_text_get_atlas(ui_text_cache* text, uint32_t* width, uint32_t* height, bool* dirty)
+{
+    *width = text->def.atlas_width;
+    *height = text->def.atlas_height;
+    if (dirty != NULL)
+        *dirty = text->atlas_dirty;
+    text->atlas_dirty = false;
+    return text->atlas;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void ui_text_get_stats(const ui_text_cache* text, uint32_t* hits, uint32_t* misses)
+{
+    *hits = text->hits;
+    *misses = text->misses;
+}
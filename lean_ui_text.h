@@ -0,0 +1,104 @@
+#ifndef __LEAN_UI_TEXT_H__
+#define __LEAN_UI_TEXT_H__
+
+#include "lean_ui.h"
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Optional module : glyph atlas and text runs cache. Glyphs come from a bitmap font or a rasterizer callback and are
+// packed in an 8-bit alpha atlas. Laid-out texts are cached, drawing a text is then one pass adding the position
+// and the color to the cached quads. ui_text_renderer() gives the draw_text and text_width callbacks for leanUI,
+// both answered from the same cache.
+//-----------------------------------------------------------------------------------------------------------------------------
+
+typedef struct
+{
+    float width, height;        // size in pixels of the glyph bitmap, can be 0 for spaces
+    float offset_x, offset_y;   // position of the bitmap relative to the pen, y from the top of the line
+    float advance;              // horizontal move of the pen after the glyph
+} ui_glyph_metrics;
+
+typedef struct
+{
+    float x0, y0, x1, y1;       // screen position
+    float u0, v0, u1, v1;       // normalized atlas coordinates
+    uint32_t srgb_color;
+} ui_text_quad;
+
+typedef struct
+{
+    const uint8_t* pixels;      // 8-bit alpha, glyphs in a grid of cells starting with first_char
+    uint32_t stride;            // in bytes
+    uint32_t cell_width, cell_height;
+    uint32_t columns;           // number of cells per row of the grid
+    uint32_t first_char, num_chars;
+} ui_bitmap_font;
+
+typedef struct
+{
+    void* preallocated_buffer;  // user-allocated memory of ui_text_min_memory_size() bytes, must be aligned on 8 bytes
+    uint32_t atlas_width, atlas_height;
+    uint32_t max_glyphs;        // glyphs in the atlas
+    uint32_t max_runs;          // cached texts, rounded up to a multiple of 4
+    uint32_t max_run_glyphs;    // glyphs of all the cached texts, also sizes the pool of their strings (4 bytes per glyph)
+    uint32_t max_quads;         // quads emitted between two ui_text_begin_frame()
+
+    // glyph source : a bitmap font (monospace) or the callbacks
+    const ui_bitmap_font* bitmap_font;
+
+    // returns false if the glyph does not exist in the font
+    bool (*glyph_metrics)(uint32_t codepoint, ui_glyph_metrics* metrics, void* user);
+
+    // writes the glyph in a width x height region of the atlas (8-bit alpha)
+    void (*rasterize_glyph)(uint32_t codepoint, uint8_t* pixels, uint32_t stride, void* user);
+
+    // optional, adjustment of the advance between two glyphs
+    float (*kerning)(uint32_t left, uint32_t right, void* user);
+
+    void* user;
+} ui_text_def;
+
+typedef struct ui_text_cache ui_text_cache;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the number of bytes needed for a text module with these settings
+size_t ui_text_min_memory_size(const ui_text_def* def);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+ui_text_cache* ui_text_init(const ui_text_def* def);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the draw_text and text_width callbacks to put in ui_def.renderer_callbacks, the other callbacks are NULL
+ui_renderer_fnc_t ui_text_renderer(ui_text_cache* text);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Resets the emitted quads, call it before ui_begin_frame(). If the atlas was full during the last frame, the atlas
+// and the texts cache are cleared here and rebuilt on the fly.
+void ui_text_begin_frame(ui_text_cache* text);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Same as the callbacks, can be used directly (e.g. for the text commands in deferred mode)
+float ui_text_width(ui_text_cache* text, const char* string);
+void ui_text_draw(ui_text_cache* text, float x, float y, const char* string, uint32_t srgb_color);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the quads emitted since ui_text_begin_frame(), in drawing order
+const ui_text_quad* ui_text_get_quads(const ui_text_cache* text, uint32_t* num_quads);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the atlas pixels (8-bit alpha, stride is the width)
+//      [dirty]     optional, set to true if glyphs were added since the last call, the texture has to be updated
+const uint8_t* ui_text_get_atlas(ui_text_cache* text, uint32_t* width, uint32_t* height, bool* dirty);
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Returns the number of hits and misses of the texts cache since ui_text_init()
+void ui_text_get_stats(const ui_text_cache* text, uint32_t* hits, uint32_t* misses);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
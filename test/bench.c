@@ -0,0 +1,889 @@
+#include "../lean_ui.h"
+#include "../lean_ui_raster.h"
+#include "../lean_ui_text.h"
+#include "bench_renderer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#define BENCH_THREADS
+#endif
+
+// results are printed as "name=value" lines, easy to parse and to diff between releases
+
+//-----------------------------------------------------------------------------------------------------------------------------
+float text_width(const char* text, void* user)
+{
+    (void) user;
+    return 8.f * strlen(text);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// widgets of test.c
+void build_window(ui_context* ctx, const char* name, float x, float y, float width, float height)
+{
+    static bool test_bool, en_dessous;
+    static uint32_t selected = 2;
+    static float quantity = 5.f;
+    static float drive = 3.f, pan = 0.f, volume = .7f;
+    const char* list[] = {"Novice", "Warrior", "Master", "Champion"};
+
+    ui_begin_window(ctx, name, x, y, width, height, window_resizable);
+    ui_text(ctx, align_left, "On the left");
+    ui_text(ctx, align_right, "On the right");
+    ui_newline(ctx);
+    ui_value(ctx, "app time", "%2.2f sec", 45.f);
+    ui_value(ctx, "delta time", "%2.2f ms", 16.f);
+    ui_toggle(ctx, "This is a toggle", &test_bool);
+    ui_toggle(ctx, "and another one", &en_dessous);
+    ui_separator(ctx);
+    ui_segmented(ctx, list, 4, &selected);
+    ui_slider(ctx, "Distance", 0.f, 100.f, 1.f, &quantity, "%3.2fkm");
+    ui_separator(ctx);
+    ui_button(ctx, "Left Button", align_left);
+    ui_button(ctx, "Center Button", align_center);
+    ui_button(ctx, "Right Button", align_right);
+    ui_newline(ctx);
+    ui_knob(ctx, "drive", 1.f, 10.f, 2.f, &drive);
+    ui_knob(ctx, "pan", -1.f, 1.f, 0.f, &pan);
+    ui_knob(ctx, "volume", 0.f, 1.f, .7f, &volume);
+    ui_newline(ctx);
+    ui_end_window(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Thread pool for the rasterizer tiles
+//-----------------------------------------------------------------------------------------------------------------------------
+
+#ifdef BENCH_THREADS
+
+#define MAX_THREADS (64)
+
+typedef struct
+{
+    pthread_t threads[MAX_THREADS];
+    uint32_t num_threads;
+    pthread_mutex_t mutex;
+    pthread_cond_t start, done;
+    uint32_t generation;
+    uint32_t running;
+    bool quit;
+
+    void (*job)(void* data, uint32_t index);
+    void* data;
+    uint32_t count;
+    atomic_uint next;
+} thread_pool;
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void run_jobs(thread_pool* pool)
+{
+    uint32_t index;
+    while ((index = atomic_fetch_add(&pool->next, 1)) < pool->count)
+        pool->job(pool->data, index);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void* worker(void* user)
+{
+    thread_pool* pool = (thread_pool*) user;
+    uint32_t generation = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+    for(;;)
+    {
+        while (pool->generation == generation && !pool->quit)
+            pthread_cond_wait(&pool->start, &pool->mutex);
+
+        if (pool->quit)
+            break;
+
+        generation = pool->generation;
+        pthread_mutex_unlock(&pool->mutex);
+        run_jobs(pool);
+        pthread_mutex_lock(&pool->mutex);
+
+        if (--pool->running == 0)
+            pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void pool_init(thread_pool* pool, uint32_t num_threads)
+{
+    memset(pool, 0, sizeof(thread_pool));
+    pool->num_threads = (num_threads > MAX_THREADS) ? MAX_THREADS : num_threads;
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    for(uint32_t i=0; i<pool->num_threads; ++i)
+        pthread_create(&pool->threads[i], NULL, worker, pool);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void pool_terminate(thread_pool* pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    pool->quit = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->mutex);
+    for(uint32_t i=0; i<pool->num_threads; ++i)
+        pthread_join(pool->threads[i], NULL);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// the calling thread helps the workers
+static void parallel_for(void (*job)(void* data, uint32_t index), void* data, uint32_t count, void* user)
+{
+    thread_pool* pool = (thread_pool*) user;
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->job = job;
+    pool->data = data;
+    pool->count = count;
+    atomic_store(&pool->next, 0);
+    pool->running = pool->num_threads;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->mutex);
+
+    run_jobs(pool);
+
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->running > 0)
+        pthread_cond_wait(&pool->done, &pool->mutex);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+#endif
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Benchmarks
+//-----------------------------------------------------------------------------------------------------------------------------
+
+#include "bench_widgets.h"
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// records a screen full of windows with the widgets of test.c
+#define GRID_COLUMNS (4)
+#define GRID_ROWS (3)
+
+static ui_context* record_screen(void* context_buffer, void* command_buffer, size_t command_buffer_size, uint32_t width, uint32_t height)
+{
+    ui_def def =
+    {
+        .preallocated_buffer = context_buffer,
+        .font_height = 16.f,
+        .renderer_callbacks = {.text_width = text_width},
+        .command_buffer = command_buffer,
+        .command_buffer_size = command_buffer_size
+    };
+    ui_context* ctx = ui_init(&def);
+
+    // windows keep a pointer on their name
+    static char names[GRID_ROWS][GRID_COLUMNS][16];
+    float window_width = (float) width / GRID_COLUMNS;
+    float window_height = (float) height / GRID_ROWS;
+
+    ui_begin_frame(ctx, 1.f/60.f);
+    for(uint32_t y=0; y<GRID_ROWS; ++y)
+        for(uint32_t x=0; x<GRID_COLUMNS; ++x)
+        {
+            snprintf(names[y][x], sizeof(names[y][x]), "window %u", y * GRID_COLUMNS + x);
+            build_window(ctx, names[y][x], x * window_width, y * window_height, window_width, window_height);
+        }
+    ui_end_frame(ctx);
+    return ctx;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void bench_raster(const char* name, uint32_t width, uint32_t height, uint32_t num_threads)
+{
+    const size_t command_buffer_size = 1 << 20;
+    void* context_buffer = malloc(ui_min_memory_size());
+    void* command_buffer = malloc(command_buffer_size);
+    ui_context* ctx = record_screen(context_buffer, command_buffer, command_buffer_size, width, height);
+
+    uint32_t num_commands;
+    const ui_command* commands = ui_get_commands(ctx, &num_commands);
+
+    ui_raster_def def =
+    {
+        .max_commands = num_commands,
+        .text_buffer_size = 0,
+        .pixels = (uint32_t*) malloc(sizeof(uint32_t) * width * height),
+        .width = width,
+        .height = height,
+        .stride = width,
+        .text_width = text_width
+    };
+
+#ifdef BENCH_THREADS
+    thread_pool pool;
+    if (num_threads > 1)
+    {
+        pool_init(&pool, num_threads - 1);
+        def.parallel_for = parallel_for;
+        def.user = &pool;
+    }
+#endif
+
+    def.preallocated_buffer = malloc(ui_raster_min_memory_size(&def));
+    ui_raster* raster = ui_raster_init(&def);
+
+    const uint32_t num_frames = 50;
+    double start = get_time();
+    for(uint32_t i=0; i<num_frames; ++i)
+    {
+        ui_raster_clear(raster, 0xFF202020);
+        ui_raster_commands(raster, commands, num_commands);
+    }
+    double elapsed = get_time() - start;
+
+    fprintf(stdout, "raster.%s.threads_%u.fps=%.1f\n", name, num_threads, num_frames / elapsed);
+    fprintf(stdout, "raster.%s.threads_%u.mpixels_per_sec=%.1f\n", name, num_threads, (double)width * height * num_frames / elapsed * 1e-6);
+
+#ifdef BENCH_THREADS
+    if (num_threads > 1)
+        pool_terminate(&pool);
+#endif
+
+    free(def.preallocated_buffer);
+    free(def.pixels);
+    free(command_buffer);
+    free(context_buffer);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// a telemetry panel full of numbers, printf path against the typed entry points
+static void bench_format(void)
+{
+    const size_t command_buffer_size = 1 << 20;
+    void* context_buffer = malloc(ui_min_memory_size());
+    void* command_buffer = malloc(command_buffer_size);
+    ui_def def =
+    {
+        .preallocated_buffer = context_buffer,
+        .font_height = 16.f,
+        .renderer_callbacks = {.text_width = text_width},
+        .command_buffer = command_buffer,
+        .command_buffer_size = command_buffer_size
+    };
+    ui_context* ctx = ui_init(&def);
+
+    const uint32_t num_values = 64;
+    const uint32_t num_frames = 2000;
+    double elapsed[2];
+
+    for(uint32_t typed=0; typed<2; ++typed)
+    {
+        double start = get_time();
+        for(uint32_t frame=0; frame<num_frames; ++frame)
+        {
+            ui_begin_frame(ctx, 1.f/60.f);
+            ui_begin_window(ctx, "telemetry", 0.f, 0.f, 400.f, 2000.f, 0);
+            for(uint32_t i=0; i<num_values; ++i)
+            {
+                float value = (float)(frame * num_values + i) * 0.37f;
+                if (typed)
+                    ui_value_float(ctx, "value", value, 2, " ms");
+                else
+                    ui_value(ctx, "value", "%.2f ms", value);
+            }
+            ui_end_window(ctx);
+            ui_end_frame(ctx);
+        }
+        elapsed[typed] = get_time() - start;
+    }
+
+    fprintf(stdout, "format.printf.ns_per_value=%.1f\n", elapsed[0] * 1e9 / (num_frames * num_values));
+    fprintf(stdout, "format.typed.ns_per_value=%.1f\n", elapsed[1] * 1e9 / (num_frames * num_values));
+
+    free(command_buffer);
+    free(context_buffer);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// mixer panel : 256 labeled knobs, drawn one by one with ui_knob() then with ui_knob_bank()
+#define MIXER_KNOBS (256)
+#define MIXER_COLUMNS (16)
+
+static void bench_knob_bank(void)
+{
+    static char labels[MIXER_KNOBS][8];
+    static const char* label_pointers[MIXER_KNOBS];
+    static float values[MIXER_KNOBS];
+    for(uint32_t i=0; i<MIXER_KNOBS; ++i)
+    {
+        snprintf(labels[i], sizeof(labels[i]), "ch %u", i);
+        label_pointers[i] = labels[i];
+        values[i] = (float) i / MIXER_KNOBS;
+    }
+
+    uint64_t num_callbacks = 0;
+    ui_context* ctx = create_null_context(&num_callbacks);
+    ui_update_mouse_pos(ctx, 200.f, 200.f);
+
+    const uint32_t num_frames = 2000;
+    double elapsed[2];
+    uint64_t callbacks[2];
+
+    // the first frame measures the labels
+    for(uint32_t bank=0; bank<2; ++bank)
+    {
+        double start = 0.0;
+        for(uint32_t frame=0; frame<=num_frames; ++frame)
+        {
+            if (frame == 1)
+            {
+                num_callbacks = 0;
+                start = get_time();
+            }
+
+            ui_begin_frame(ctx, 1.f/60.f);
+            ui_begin_window(ctx, "mixer", 0.f, 0.f, 16.f * 100.f, 2000.f, 0);
+            if (bank)
+                ui_knob_bank(ctx, label_pointers, MIXER_KNOBS, MIXER_COLUMNS, 0.f, 1.f, .5f, values);
+            else
+            {
+                for(uint32_t i=0; i<MIXER_KNOBS; ++i)
+                {
+                    ui_knob(ctx, label_pointers[i], 0.f, 1.f, .5f, &values[i]);
+                    if (i % MIXER_COLUMNS == MIXER_COLUMNS - 1)
+                        ui_newline(ctx);
+                }
+            }
+            ui_end_window(ctx);
+            ui_end_frame(ctx);
+        }
+        elapsed[bank] = get_time() - start;
+        callbacks[bank] = num_callbacks;
+    }
+
+    fprintf(stdout, "knobs.single.ns_per_knob=%.1f\n", elapsed[0] * 1e9 / (num_frames * MIXER_KNOBS));
+    fprintf(stdout, "knobs.bank.ns_per_knob=%.1f\n", elapsed[1] * 1e9 / (num_frames * MIXER_KNOBS));
+    fprintf(stdout, "knobs.same_callbacks=%d\n", callbacks[0] == callbacks[1]);
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// streaming plot of a large ring buffer, 1000 new samples per frame, with and without the summary
+#define PLOT_BLOCK_SIZE (16)
+
+static void bench_plot(const char* name, uint32_t capacity)
+{
+    float* samples = (float*) malloc(capacity * sizeof(float));
+    float* min_values = (float*) malloc(ui_plot_summary_size(capacity, PLOT_BLOCK_SIZE) * sizeof(float));
+    float* max_values = (float*) malloc(ui_plot_summary_size(capacity, PLOT_BLOCK_SIZE) * sizeof(float));
+    for(uint32_t i=0; i<capacity; ++i)
+        samples[i] = (float) ((i * 2654435761u) >> 16 & 0xFFFF) / 65535.f;
+
+    ui_plot_summary summary = {.min_values = min_values, .max_values = max_values, .block_size = PLOT_BLOCK_SIZE};
+    ui_plot_summary_update(&summary, samples, capacity, 0, capacity);
+
+    uint64_t num_callbacks = 0;
+    ui_context* ctx = create_null_context(&num_callbacks);
+
+    const uint32_t num_frames = 200;
+    const uint32_t new_samples = 1000;
+    double elapsed[2];
+    ui_plot_data data = {.samples = samples, .capacity = capacity, .count = capacity};
+
+    for(uint32_t with_summary=0; with_summary<2; ++with_summary)
+    {
+        data.summary = with_summary ? &summary : NULL;
+        double start = get_time();
+        for(uint32_t frame=0; frame<num_frames; ++frame)
+        {
+            for(uint32_t i=0; i<new_samples; ++i)
+                samples[(data.first + i) % capacity] = (float) (i & 255) / 255.f;
+            if (with_summary)
+                ui_plot_summary_update(&summary, samples, capacity, data.first, new_samples);
+            data.first = (data.first + new_samples) % capacity;
+
+            ui_begin_frame(ctx, 1.f/60.f);
+            ui_begin_window(ctx, "plot", 0.f, 0.f, 640.f, 400.f, 0);
+            ui_plot(ctx, "samples", &data, 0.f, 1.f, 300.f);
+            ui_end_window(ctx);
+            ui_end_frame(ctx);
+        }
+        elapsed[with_summary] = get_time() - start;
+    }
+
+    fprintf(stdout, "plot.%s.raw.us_per_frame=%.1f\n", name, elapsed[0] * 1e6 / num_frames);
+    fprintf(stdout, "plot.%s.summary.us_per_frame=%.1f\n", name, elapsed[1] * 1e6 / num_frames);
+
+    free(ctx);
+    free(max_values);
+    free(min_values);
+    free(samples);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// histogram binning of 1M values (scalar loop vs ui_histogram_bin) and a 256x64 heatmap
+#define HISTOGRAM_VALUES (1 << 20)
+#define HEATMAP_COLUMNS (256)
+#define HEATMAP_ROWS (64)
+
+static void bench_charts(void)
+{
+    float* values = (float*) malloc(HISTOGRAM_VALUES * sizeof(float));
+    for(uint32_t i=0; i<HISTOGRAM_VALUES; ++i)
+        values[i] = (float) ((i * 2654435761u) >> 16 & 0xFFFF) / 65535.f;
+
+    static uint32_t bins[2][64];
+    const uint32_t num_passes = 20;
+    double elapsed[2];
+    for(uint32_t simd=0; simd<2; ++simd)
+    {
+        double start = get_time();
+        for(uint32_t pass=0; pass<num_passes; ++pass)
+        {
+            if (simd)
+                ui_histogram_bin(values, HISTOGRAM_VALUES, 0.f, 1.f, bins[1], 64);
+            else
+                for(uint32_t i=0; i<HISTOGRAM_VALUES; ++i)
+                {
+                    float x = values[i] * 64.f;
+                    bins[0][(x < 0.f) ? 0 : (x > 63.f) ? 63 : (uint32_t) x]++;
+                }
+        }
+        elapsed[simd] = get_time() - start;
+    }
+
+    fprintf(stdout, "histogram.scalar.ns_per_value=%.2f\n", elapsed[0] * 1e9 / ((double) num_passes * HISTOGRAM_VALUES));
+    fprintf(stdout, "histogram.simd.ns_per_value=%.2f\n", elapsed[1] * 1e9 / ((double) num_passes * HISTOGRAM_VALUES));
+    fprintf(stdout, "histogram.same_bins=%d\n", memcmp(bins[0], bins[1], sizeof(bins[0])) == 0);
+
+    // latency distribution over time : a band around a drifting median, empty cells elsewhere
+    static float cells[HEATMAP_ROWS][HEATMAP_COLUMNS];
+    for(uint32_t y=0; y<HEATMAP_ROWS; ++y)
+        for(uint32_t x=0; x<HEATMAP_COLUMNS; ++x)
+        {
+            float distance = ((float) y - 32.f - 12.f * sinf((float) x * .03f)) / 6.f;
+            cells[y][x] = expf(-distance * distance);
+        }
+
+    uint64_t num_callbacks = 0;
+    ui_context* ctx = create_null_context(&num_callbacks);
+
+    const uint32_t num_frames = 500;
+    double start = get_time();
+    for(uint32_t frame=0; frame<num_frames; ++frame)
+    {
+        ui_begin_frame(ctx, 1.f/60.f);
+        ui_begin_window(ctx, "heatmap", 0.f, 0.f, 800.f, 400.f, 0);
+        ui_heatmap(ctx, "latency", &cells[0][0], HEATMAP_COLUMNS, HEATMAP_ROWS, 0.f, 1.f, 320.f);
+        ui_end_window(ctx);
+        ui_end_frame(ctx);
+    }
+    double heatmap_time = get_time() - start;
+
+    fprintf(stdout, "heatmap.us_per_frame=%.1f\n", heatmap_time * 1e6 / num_frames);
+    fprintf(stdout, "heatmap.callbacks_per_frame=%.1f\n", (double) num_callbacks / num_frames);
+    fprintf(stdout, "heatmap.cells=%u\n", HEATMAP_COLUMNS * HEATMAP_ROWS);
+
+    free(ctx);
+    free(values);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// table of processes : the frame time depends on the visible rows, sorting is paid once then rows are inserted
+#define TABLE_MAX_ROWS (60000)
+
+static uint32_t table_memory[TABLE_MAX_ROWS];
+
+static const char* process_cell(uint32_t row, uint32_t column, void* user)
+{
+    static char buffer[32];
+    (void) user;
+    snprintf(buffer, sizeof(buffer), (column == 0) ? "process %u" : "%u", (column == 0) ? row : table_memory[row] >> column);
+    return buffer;
+}
+
+static int process_compare(uint32_t row_a, uint32_t row_b, uint32_t column, void* user)
+{
+    (void) user;
+    uint32_t a = (column == 0) ? row_a : table_memory[row_a] >> column;
+    uint32_t b = (column == 0) ? row_b : table_memory[row_b] >> column;
+    return (a > b) - (a < b);
+}
+
+static void bench_table(void)
+{
+    static uint32_t order[TABLE_MAX_ROWS];
+    for(uint32_t i=0; i<TABLE_MAX_ROWS; ++i)
+        table_memory[i] = (i * 2654435761u) >> 8;
+
+    uint64_t num_callbacks = 0;
+    ui_context* ctx = create_null_context(&num_callbacks);
+
+    ui_table_column columns[4] = {{"name", 200.f}, {"memory", 120.f}, {"cpu", 120.f}, {"threads", 120.f}};
+    ui_table_data table = {.columns = columns, .num_columns = 4, .order = order, .sort_column = 1,
+                           .cell_text = process_cell, .compare_rows = process_compare};
+
+    const uint32_t num_frames = 1000;
+    const uint32_t sizes[2] = {500, 50000};
+    for(uint32_t size=0; size<2; ++size)
+    {
+        table.num_rows = sizes[size];
+        table.num_sorted = 0;
+
+        // the first frame sorts
+        double start = get_time();
+        double sort_time = 0.0;
+        for(uint32_t frame=0; frame<=num_frames; ++frame)
+        {
+            ui_begin_frame(ctx, 1.f/60.f);
+            ui_begin_window(ctx, "processes", 0.f, 0.f, 600.f, 800.f, window_scrollable);
+            ui_table(ctx, &table);
+            ui_end_window(ctx);
+            ui_end_frame(ctx);
+
+            if (frame == 0)
+            {
+                sort_time = get_time() - start;
+                start = get_time();
+            }
+        }
+        double elapsed = get_time() - start;
+        fprintf(stdout, "table.%u_rows.us_per_frame=%.1f\n", sizes[size], elapsed * 1e6 / num_frames);
+        fprintf(stdout, "table.%u_rows.first_frame_ms=%.2f\n", sizes[size], sort_time * 1e3);
+    }
+
+    // streaming : 100 new rows per frame in the sorted table
+    double start = get_time();
+    uint32_t num_append_frames = (TABLE_MAX_ROWS - table.num_rows) / 100;
+    for(uint32_t frame=0; frame<num_append_frames; ++frame)
+    {
+        table.num_rows += 100;
+        ui_begin_frame(ctx, 1.f/60.f);
+        ui_begin_window(ctx, "processes", 0.f, 0.f, 600.f, 800.f, window_scrollable);
+        ui_table(ctx, &table);
+        ui_end_window(ctx);
+        ui_end_frame(ctx);
+    }
+    fprintf(stdout, "table.append_100_rows.us_per_frame=%.1f\n", (get_time() - start) * 1e6 / num_append_frames);
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// log of 64 MB : indexing is paid once per byte, then the frame time depends on the visible lines only
+#define LOG_SIZE ((size_t)64 << 20)
+#define LOG_APPEND_SIZE (64 << 10)
+
+static void bench_log(void)
+{
+    char* text = (char*) malloc(LOG_SIZE);
+    size_t length = 0;
+    for(uint32_t i=0; length + 128 < LOG_SIZE; ++i)
+        length += (size_t) sprintf(text + length, "12:%02u:%02u.%06u [info] worker %u processed request %u\n",
+                                   (i / 60000000) % 60, (i / 1000000) % 60, i % 1000000, i % 16, i);
+
+    uint32_t max_lines = 1 << 21;
+    size_t* line_starts = (size_t*) malloc(max_lines * sizeof(size_t));
+    ui_log_data log = {.text = text, .length = length / 2, .line_starts = line_starts, .max_lines = max_lines, .follow_tail = true};
+
+    uint64_t num_callbacks = 0;
+    ui_context* ctx = create_null_context(&num_callbacks);
+
+    // the first frames index the first half, 16 MB per frame
+    double start = get_time();
+    uint32_t num_frames = 0;
+    while (log.length <= length)
+    {
+        ui_begin_frame(ctx, 1.f/60.f);
+        ui_begin_window(ctx, "log", 0.f, 0.f, 1200.f, 900.f, 0);
+        ui_log(ctx, &log, 800.f);
+        ui_end_window(ctx);
+        ui_end_frame(ctx);
+
+        if (num_frames++ == 0)
+        {
+            double elapsed = get_time() - start;
+            fprintf(stdout, "log.first_frame_16mb.ms=%.2f\n", elapsed * 1e3);
+            fprintf(stdout, "log.index.gb_per_s=%.2f\n", (double) log.indexed_length / elapsed * 1e-9);
+            start = get_time();
+        }
+
+        if (log.length == length)
+            break;
+        log.length = (length - log.length < LOG_APPEND_SIZE) ? length : log.length + LOG_APPEND_SIZE;
+    }
+    fprintf(stdout, "log.tail_append_64kb.us_per_frame=%.1f\n", (get_time() - start) * 1e6 / (num_frames - 1));
+
+    // same log without new text
+    const uint32_t num_static_frames = 1000;
+    start = get_time();
+    for(uint32_t frame=0; frame<num_static_frames; ++frame)
+    {
+        ui_begin_frame(ctx, 1.f/60.f);
+        ui_begin_window(ctx, "log", 0.f, 0.f, 1200.f, 900.f, 0);
+        ui_log(ctx, &log, 800.f);
+        ui_end_window(ctx);
+        ui_end_frame(ctx);
+    }
+    fprintf(stdout, "log.tail.us_per_frame=%.1f\n", (get_time() - start) * 1e6 / num_static_frames);
+    fprintf(stdout, "log.lines=%u\n", log.num_lines);
+
+    free(ctx);
+    free(line_starts);
+    free(text);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// 8-bit lerp of the sRGB values, the blend used before the linear space tables
+static uint32_t srgb_lerp(uint32_t a, uint32_t b, float t)
+{
+    uint32_t tt = (uint32_t)(t * 256.f), result = 0;
+    for(uint32_t shift=0; shift<32; shift+=8)
+        result |= (((a >> shift) & 0xFF) * (256 - tt) + ((b >> shift) & 0xFF) * tt) >> 8 << shift;
+    return result;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// per-channel conversion with powf, what the tables replace
+static uint32_t pow_lerp(uint32_t a, uint32_t b, float t)
+{
+    uint32_t result = 0;
+    for(uint32_t shift=0; shift<24; shift+=8)
+    {
+        float ca = powf((float)((a >> shift) & 0xFF) / 255.f, 2.2f);
+        float cb = powf((float)((b >> shift) & 0xFF) / 255.f, 2.2f);
+        result |= (uint32_t) (powf(ca + (cb - ca) * t, 1.f / 2.2f) * 255.f + .5f) << shift;
+    }
+    return result | ((uint32_t) ((float)(a >> 24) + ((float)(b >> 24) - (float)(a >> 24)) * t + .5f) << 24);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// color interpolation throughput, the colors and t change at each call
+static void bench_color_lerp(void)
+{
+    uint64_t num_callbacks = 0;
+    ui_context* ctx = create_null_context(&num_callbacks);
+
+    const uint32_t num_lerps = 1 << 22;
+    uint32_t checksum = 0;
+    double elapsed[3];
+
+    for(uint32_t method=0; method<3; ++method)
+    {
+        double start = get_time();
+        uint32_t a = 0xFF203040, b = 0xC0F0E0D0;
+        for(uint32_t i=0; i<num_lerps; ++i)
+        {
+            float t = (float) (i & 255) * (1.f / 255.f);
+            uint32_t color = (method == 0) ? srgb_lerp(a, b, t) : (method == 1) ? pow_lerp(a, b, t) : ui_color_lerp(ctx, a, b, t);
+            checksum += color;
+            a = a * 1664525u + 1013904223u;
+            b ^= color;
+        }
+        elapsed[method] = get_time() - start;
+    }
+
+    fprintf(stdout, "color.srgb_8bit.ns_per_lerp=%.2f\n", elapsed[0] * 1e9 / num_lerps);
+    fprintf(stdout, "color.powf.ns_per_lerp=%.2f\n", elapsed[1] * 1e9 / num_lerps);
+    fprintf(stdout, "color.linear_tables.ns_per_lerp=%.2f\n", elapsed[2] * 1e9 / num_lerps);
+    fprintf(stdout, "color.checksum=%08x\n", checksum);
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// text module : widths answered by the runs cache, the text commands of the frame are turned into atlas quads
+static void bench_text(void)
+{
+    static uint8_t font_pixels[128 * 96];
+    for(uint32_t i=0; i<sizeof(font_pixels); ++i)
+        font_pixels[i] = (uint8_t) (i * 31);
+
+    ui_bitmap_font font = {.pixels = font_pixels, .stride = 128, .cell_width = 8, .cell_height = 16, .columns = 16,
+                           .first_char = ' ', .num_chars = 95};
+    ui_text_def text_def = {.atlas_width = 256, .atlas_height = 256, .max_glyphs = 128, .max_runs = 256,
+                            .max_run_glyphs = 8192, .max_quads = 1 << 16, .bitmap_font = &font};
+    text_def.preallocated_buffer = malloc(ui_text_min_memory_size(&text_def));
+    ui_text_cache* text = ui_text_init(&text_def);
+    ui_renderer_fnc_t renderer = ui_text_renderer(text);
+
+    const size_t command_buffer_size = 1 << 20;
+    void* context_buffer = malloc(ui_min_memory_size());
+    void* command_buffer = malloc(command_buffer_size);
+    ui_def def =
+    {
+        .preallocated_buffer = context_buffer,
+        .font_height = 16.f,
+        .renderer_callbacks = renderer,
+        .command_buffer = command_buffer,
+        .command_buffer_size = command_buffer_size
+    };
+    ui_context* ctx = ui_init(&def);
+
+    const uint32_t num_frames = 2000;
+    uint32_t num_quads = 0;
+    double start = get_time();
+    for(uint32_t frame=0; frame<num_frames; ++frame)
+    {
+        ui_text_begin_frame(text);
+        ui_begin_frame(ctx, 1.f/60.f);
+        build_window(ctx, "text 0", 0.f, 0.f, 400.f, 1000.f);
+        build_window(ctx, "text 1", 420.f, 0.f, 400.f, 1000.f);
+        build_window(ctx, "text 2", 840.f, 0.f, 400.f, 1000.f);
+        build_window(ctx, "text 3", 1260.f, 0.f, 400.f, 1000.f);
+        ui_end_frame(ctx);
+
+        uint32_t num_commands;
+        const ui_command* commands = ui_get_commands(ctx, &num_commands);
+        for(uint32_t i=0; i<num_commands; ++i)
+            if (commands[i].type == command_text)
+                ui_text_draw(text, commands[i].data.text.x, commands[i].data.text.y, commands[i].data.text.text, commands[i].srgb_color);
+        ui_text_get_quads(text, &num_quads);
+    }
+    double elapsed = get_time() - start;
+
+    uint32_t hits, misses;
+    ui_text_get_stats(text, &hits, &misses);
+    fprintf(stdout, "text.us_per_frame=%.2f\n", elapsed * 1e6 / num_frames);
+    fprintf(stdout, "text.quads_per_frame=%u\n", num_quads);
+    fprintf(stdout, "text.hit_rate=%.4f\n", (double) hits / (double) (hits + misses));
+
+    free(command_buffer);
+    free(context_buffer);
+    free(text_def.preallocated_buffer);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// heavy panels built on several threads, one context per thread, merged in the main context
+#define PARALLEL_WINDOWS (12)
+#define PARALLEL_WIDGETS (64)
+
+typedef struct
+{
+    ui_context* main;
+    ui_context* workers[PARALLEL_WINDOWS];
+    uint32_t num_workers;
+    uint32_t frame;
+} parallel_frame;
+
+static void build_panels(void* data, uint32_t index)
+{
+    static const char* names[PARALLEL_WINDOWS] = {"p0", "p1", "p2", "p3", "p4", "p5", "p6", "p7", "p8", "p9", "p10", "p11"};
+    parallel_frame* frame = (parallel_frame*) data;
+    ui_context* ctx = frame->workers[index];
+
+    ui_copy_input(ctx, frame->main);
+    ui_begin_frame(ctx, 1.f/60.f);
+    for(uint32_t w=index; w<PARALLEL_WINDOWS; w+=frame->num_workers)
+    {
+        ui_begin_window(ctx, names[w], (w % 4) * 480.f, (w / 4) * 360.f, 480.f, 4000.f, 0);
+        for(uint32_t i=0; i<PARALLEL_WIDGETS; ++i)
+            ui_value(ctx, "value", "%.3f", (float)(frame->frame + i) * .1f);
+        ui_end_window(ctx);
+    }
+    ui_end_frame(ctx);
+}
+
+static void bench_parallel(uint32_t num_threads)
+{
+    const size_t command_buffer_size = 1 << 20;
+    const size_t context_size = (ui_min_memory_size() + 7) & ~(size_t)7;
+    parallel_frame frame = {.num_workers = num_threads};
+    void* buffers[PARALLEL_WINDOWS + 1];
+
+    for(uint32_t i=0; i<=num_threads; ++i)
+    {
+        buffers[i] = malloc(context_size + command_buffer_size);
+        ui_def def =
+        {
+            .preallocated_buffer = buffers[i],
+            .font_height = 16.f,
+            .renderer_callbacks = {.text_width = text_width},
+            .command_buffer = (uint8_t*) buffers[i] + context_size,
+            .command_buffer_size = command_buffer_size
+        };
+        ui_context* ctx = ui_init(&def);
+        if (i == 0)
+            frame.main = ctx;
+        else
+            frame.workers[i - 1] = ctx;
+    }
+
+#ifdef BENCH_THREADS
+    thread_pool pool;
+    if (num_threads > 1)
+        pool_init(&pool, num_threads - 1);
+#endif
+
+    const uint32_t num_frames = 500;
+    double start = get_time();
+    for(frame.frame=0; frame.frame<num_frames; ++frame.frame)
+    {
+#ifdef BENCH_THREADS
+        if (num_threads > 1)
+            parallel_for(build_panels, &frame, num_threads, &pool);
+        else
+#endif
+        for(uint32_t i=0; i<num_threads; ++i)
+            build_panels(&frame, i);
+
+        ui_begin_frame(frame.main, 1.f/60.f);
+        for(uint32_t i=0; i<num_threads; ++i)
+            ui_merge_commands(frame.main, frame.workers[i]);
+        ui_end_frame(frame.main);
+    }
+    double elapsed = get_time() - start;
+
+    fprintf(stdout, "parallel.threads_%u.ns_per_frame=%.1f\n", num_threads, elapsed * 1e9 / num_frames);
+
+#ifdef BENCH_THREADS
+    if (num_threads > 1)
+        pool_terminate(&pool);
+#endif
+
+    for(uint32_t i=0; i<=num_threads; ++i)
+        free(buffers[i]);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+int main(void)
+{
+    uint32_t num_cores = 1;
+#ifdef BENCH_THREADS
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    num_cores = (n > 1) ? (uint32_t) n : 1;
+#endif
+
+    bench_all_widgets("widgets");
+
+    bench_format();
+    bench_text();
+    bench_color_lerp();
+    bench_knob_bank();
+    bench_plot("64k", 1 << 16);
+    bench_plot("4m", 1 << 22);
+    bench_charts();
+    bench_table();
+    bench_log();
+
+    bench_parallel(1);
+    if (num_cores > 1)
+        bench_parallel((num_cores < PARALLEL_WINDOWS) ? num_cores : PARALLEL_WINDOWS);
+
+    bench_raster("1080p", 1920, 1080, 1);
+    bench_raster("4k", 3840, 2160, 1);
+    if (num_cores > 1)
+    {
+        bench_raster("1080p", 1920, 1080, num_cores);
+        bench_raster("4k", 3840, 2160, num_cores);
+    }
+
+    return 0;
+}
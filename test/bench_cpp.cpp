@@ -0,0 +1,108 @@
+#include "../lean_ui.hpp"
+#include "bench_renderer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// the same panel built with the C api and with the C++ layer, both should run at the same speed
+
+static_assert(ui::id("Settings") == UI_ID("Settings"), "ui::id() and UI_ID() must give the same value");
+
+#define PANEL_WINDOWS (8)
+#define PANEL_ROWS (8)
+
+struct panel_state
+{
+    bool toggles[PANEL_WINDOWS][PANEL_ROWS];
+    float values[PANEL_WINDOWS][PANEL_ROWS];
+    float gains[PANEL_WINDOWS][PANEL_ROWS];
+    uint32_t selected[PANEL_WINDOWS];
+};
+
+static const char* window_names[PANEL_WINDOWS] = {"w0", "w1", "w2", "w3", "w4", "w5", "w6", "w7"};
+static const char* entries[] = {"One", "Two", "Three", "Four"};
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void build_c(ui_context* ctx, panel_state* state)
+{
+    ui_begin_frame(ctx, 1.f/60.f);
+    for(uint32_t w=0; w<PANEL_WINDOWS; ++w)
+    {
+        ui_begin_window(ctx, window_names[w], w * 240.f, 0.f, 240.f, 4000.f, 0);
+        ui_segmented(ctx, entries, 4, &state->selected[w]);
+        for(uint32_t i=0; i<PANEL_ROWS; ++i)
+        {
+            ui_toggle(ctx, "toggle", &state->toggles[w][i]);
+            ui_slider_float(ctx, "slider", 0.f, 100.f, 1.f, &state->values[w][i], 0, NULL);
+            ui_value_float(ctx, "value", state->values[w][i], 2, " ms");
+            ui_knob(ctx, "gain", 0.f, 1.f, .5f, &state->gains[w][i]);
+            ui_newline(ctx);
+            ui_button(ctx, "button", align_left);
+            ui_newline(ctx);
+        }
+        ui_end_window(ctx);
+    }
+    ui_end_frame(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void build_cpp(ui_context* ctx, panel_state* state)
+{
+    ui::frame frame(ctx, 1.f/60.f);
+    for(uint32_t w=0; w<PANEL_WINDOWS; ++w)
+    {
+        ui::window window(ctx, window_names[w], w * 240.f, 0.f, 240.f, 4000.f);
+        ui::segmented(ctx, entries, state->selected[w]);
+        for(uint32_t i=0; i<PANEL_ROWS; ++i)
+        {
+            ui::toggle(ctx, "toggle", state->toggles[w][i]);
+            ui::slider(ctx, "slider", 0.f, 100.f, 1.f, state->values[w][i], 0);
+            ui::value(ctx, "value", state->values[w][i], 2, " ms");
+            ui::knob(ctx, "gain", 0.f, 1.f, .5f, state->gains[w][i]);
+            ui::newline(ctx);
+            ui::button(ctx, "button");
+            ui::newline(ctx);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+int main()
+{
+    static panel_state state;
+    uint64_t num_callbacks = 0;
+    void* context_buffer = malloc(ui_min_memory_size());
+    ui_def def = {};
+    def.preallocated_buffer = context_buffer;
+    def.font_height = 16.f;
+    def.renderer_callbacks = {null_draw_box, null_draw_text, null_draw_line, null_set_clip_rect, null_text_width, &num_callbacks};
+    ui_context* ctx = ui_init(&def);
+    ui_update_mouse_pos(ctx, -100.f, -100.f);
+
+    // first frame : windows created and text widths cached
+    build_c(ctx, &state);
+
+    const uint32_t num_frames = 2000;
+    const char* names[2] = {"c", "cpp"};
+    uint64_t callbacks[2];
+    for(uint32_t api=0; api<2; ++api)
+    {
+        num_callbacks = 0;
+        double start = get_time();
+        for(uint32_t frame=0; frame<num_frames; ++frame)
+        {
+            if (api == 0)
+                build_c(ctx, &state);
+            else
+                build_cpp(ctx, &state);
+        }
+        double elapsed = get_time() - start;
+        callbacks[api] = num_callbacks;
+        fprintf(stdout, "api.%s.ns_per_frame=%.1f\n", names[api], elapsed * 1e9 / num_frames);
+    }
+
+    // same draw calls
+    fprintf(stdout, "api.same_callbacks=%d\n", callbacks[0] == callbacks[1]);
+
+    free(context_buffer);
+    return (callbacks[0] == callbacks[1]) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
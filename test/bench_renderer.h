@@ -0,0 +1,80 @@
+#ifndef __BENCH_RENDERER_H__
+#define __BENCH_RENDERER_H__
+
+// shared by the benchmarks, the null renderer does not depend on lean_ui.h : leanui_bench_static binds these functions at
+// compile time before including the implementation, create_null_context is only defined once lean_ui.h is included
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static double get_time(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// Null renderer, only counts the callbacks
+//-----------------------------------------------------------------------------------------------------------------------------
+
+static void null_draw_box(float x, float y, float width, float height, float radius, uint32_t srgb_color, void* user)
+{
+    (void) x; (void) y; (void) width; (void) height; (void) radius; (void) srgb_color;
+    (*(uint64_t*) user)++;
+}
+
+static void null_draw_text(float x, float y, const char* text, uint32_t srgb_color, void* user)
+{
+    (void) x; (void) y; (void) text; (void) srgb_color;
+    (*(uint64_t*) user)++;
+}
+
+static void null_draw_line(float x0, float y0, float x1, float y1, float width, uint32_t srgb_color, void* user)
+{
+    (void) x0; (void) y0; (void) x1; (void) y1; (void) width; (void) srgb_color;
+    (*(uint64_t*) user)++;
+}
+
+static void null_set_clip_rect(uint16_t min_x, uint16_t min_y, uint16_t max_x, uint16_t max_y, void* user)
+{
+    (void) min_x; (void) min_y; (void) max_x; (void) max_y;
+    (*(uint64_t*) user)++;
+}
+
+static float null_text_width(const char* text, void* user)
+{
+    (*(uint64_t*) user)++;
+    return 8.f * strlen(text);
+}
+
+#endif
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// context drawing with the null renderer in immediate mode, free() it after use (C only, designated initializers)
+#if defined(__LEAN_UI_H__) && !defined(__cplusplus) && !defined(__BENCH_NULL_CONTEXT__)
+#define __BENCH_NULL_CONTEXT__
+
+static ui_context* create_null_context(uint64_t* counter)
+{
+    ui_def def =
+    {
+        .preallocated_buffer = malloc(ui_min_memory_size()),
+        .font_height = 16.f,
+        .renderer_callbacks =
+        {
+            .draw_box = null_draw_box,
+            .draw_text = null_draw_text,
+            .draw_line = null_draw_line,
+            .set_clip_rect = null_set_clip_rect,
+            .text_width = null_text_width,
+            .user = counter
+        }
+    };
+    return ui_init(&def);
+}
+
+#endif
@@ -0,0 +1,21 @@
+#include "bench_renderer.h"
+
+// lean_ui.c compiled in this file with the null renderer bound at compile time, compare the results with the
+// widgets.* lines of leanui_bench that go through the renderer callbacks
+
+#define UI_RENDERER_DRAW_BOX null_draw_box
+#define UI_RENDERER_DRAW_TEXT null_draw_text
+#define UI_RENDERER_DRAW_LINE null_draw_line
+#define UI_RENDERER_SET_CLIP_RECT null_set_clip_rect
+#define UI_RENDERER_TEXT_WIDTH null_text_width
+#define LEAN_UI_IMPLEMENTATION
+#include "../lean_ui.h"
+
+#include "bench_widgets.h"
+
+//-----------------------------------------------------------------------------------------------------------------------------
+int main(void)
+{
+    bench_all_widgets("widgets_static");
+    return 0;
+}
@@ -0,0 +1,83 @@
+#ifndef __BENCH_WIDGETS_H__
+#define __BENCH_WIDGETS_H__
+
+// widgets benchmark shared by leanui_bench (renderer callbacks) and leanui_bench_static (renderer bound at compile time)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench_renderer.h"
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// N windows x M widgets of a single type, measures the cost of leanUI itself
+enum bench_widget
+{
+    bench_toggle,
+    bench_slider,
+    bench_segmented,
+    bench_knob,
+    bench_button,
+    bench_value,
+    bench_value_float,
+    bench_widget_count
+};
+
+#define BENCH_WINDOWS (8)
+#define BENCH_WIDGETS (32)
+
+static void bench_widgets(enum bench_widget type, const char* prefix, const char* name)
+{
+    static const char* window_names[BENCH_WINDOWS] = {"w0", "w1", "w2", "w3", "w4", "w5", "w6", "w7"};
+    static bool toggles[BENCH_WINDOWS][BENCH_WIDGETS];
+    static float values[BENCH_WINDOWS][BENCH_WIDGETS];
+    static uint32_t selected[BENCH_WINDOWS][BENCH_WIDGETS];
+    const char* entries[] = {"One", "Two", "Three", "Four"};
+
+    uint64_t num_callbacks = 0;
+    ui_context* ctx = create_null_context(&num_callbacks);
+    ui_update_mouse_pos(ctx, -100.f, -100.f);
+
+    const uint32_t num_frames = 2000;
+    double start = get_time();
+    for(uint32_t frame=0; frame<num_frames; ++frame)
+    {
+        ui_begin_frame(ctx, 1.f/60.f);
+        for(uint32_t w=0; w<BENCH_WINDOWS; ++w)
+        {
+            // tall enough to show all the widgets
+            ui_begin_window(ctx, window_names[w], w * 240.f, 0.f, 240.f, 4000.f, 0);
+            for(uint32_t i=0; i<BENCH_WIDGETS; ++i)
+            {
+                switch(type)
+                {
+                case bench_toggle: ui_toggle(ctx, "toggle", &toggles[w][i]); break;
+                case bench_slider: ui_slider(ctx, "slider", 0.f, 100.f, 1.f, &values[w][i], "%3.2f"); break;
+                case bench_segmented: ui_segmented(ctx, entries, 4, &selected[w][i]); break;
+                case bench_knob: ui_knob(ctx, "knob", 0.f, 1.f, .5f, &values[w][i]); ui_newline(ctx); break;
+                case bench_button: ui_button(ctx, "button", align_left); ui_newline(ctx); break;
+                case bench_value: ui_value(ctx, "value", "%.2f ms", (float) i); break;
+                default: ui_value_float(ctx, "value", (float) i, 2, " ms"); break;
+                }
+            }
+            ui_end_window(ctx);
+        }
+        ui_end_frame(ctx);
+    }
+    double elapsed = get_time() - start;
+    double num_widgets = (double) num_frames * BENCH_WINDOWS * BENCH_WIDGETS;
+
+    fprintf(stdout, "%s.%s.ns_per_widget=%.1f\n", prefix, name, elapsed * 1e9 / num_widgets);
+    fprintf(stdout, "%s.%s.ns_per_frame=%.1f\n", prefix, name, elapsed * 1e9 / num_frames);
+    fprintf(stdout, "%s.%s.callbacks_per_frame=%.1f\n", prefix, name, (double) num_callbacks / num_frames);
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void bench_all_widgets(const char* prefix)
+{
+    const char* widget_names[bench_widget_count] = {"toggle", "slider", "segmented", "knob", "button", "value", "value_float"};
+    for(uint32_t i=0; i<bench_widget_count; ++i)
+        bench_widgets((enum bench_widget) i, prefix, widget_names[i]);
+}
+
+#endif
@@ -0,0 +1,1936 @@
+#include "../lean_ui.h"
+#include "../lean_ui_mesh.h"
+#include "../lean_ui_raster.h"
+#include "../lean_ui_replay.h"
+#include "../lean_ui_text.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <float.h>
+
+static int num_failures = 0;
+
+#define CHECK(condition) do { if (!(condition)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); num_failures++; } } while(0)
+
+//-----------------------------------------------------------------------------------------------------------------------------
+float text_width(const char* text, void* user)
+{
+    (void) user;
+    return 16.f * strlen(text);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// deferred context, the command buffer is allocated after the context
+ui_context* create_context(size_t command_buffer_size)
+{
+    size_t context_size = (ui_min_memory_size() + 7) & ~(size_t)7;
+    uint8_t* buffer = (uint8_t*) malloc(context_size + command_buffer_size);
+    ui_def def =
+    {
+        .preallocated_buffer = buffer,
+        .font_height = 32.f,
+        .renderer_callbacks = {.text_width = text_width},
+        .command_buffer = buffer + context_size,
+        .command_buffer_size = command_buffer_size
+    };
+    return ui_init(&def);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// same widgets as test.c
+void build_widgets(ui_context* ctx)
+{
+    static bool test_bool, en_dessous;
+    static uint32_t selected = 2;
+    static float quantity = 5.f;
+    static float drive = 3.f, pan = 0.f, volume = .7f;
+    const char* list[] = {"Novice", "Warrior", "Master", "Champion"};
+
+    ui_begin_window(ctx, "Alright let's play!", 800, 100, 600, 1600, window_resizable);
+    ui_text(ctx, align_left, "On the left");
+    ui_text(ctx, align_right, "On the right");
+    ui_newline(ctx);
+    ui_value(ctx, "app time", "%2.2f sec", 45.f);
+    ui_value(ctx, "delta time", "%2.2f ms", 16.f);
+    ui_toggle(ctx, "This is a toggle", &test_bool);
+    ui_toggle(ctx, "and another one", &en_dessous);
+    ui_separator(ctx);
+    ui_segmented(ctx, list, 4, &selected);
+    ui_slider(ctx, "Distance", 0.f, 100.f, 1.f, &quantity, "%3.2fkm");
+    ui_separator(ctx);
+    ui_button(ctx, "Left Button", align_left);
+    ui_button(ctx, "Center Button", align_center);
+    ui_button(ctx, "Right Button", align_right);
+    ui_newline(ctx);
+    ui_knob(ctx, "drive", 1.f, 10.f, 2.f, &drive);
+    ui_knob(ctx, "pan", -1.f, 1.f, 0.f, &pan);
+    ui_knob(ctx, "volume", 0.f, 1.f, .7f, &volume);
+    ui_newline(ctx);
+    ui_end_window(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static bool vertices_in_rect(const ui_mesh* mesh, float x, float y, float width, float height, float margin)
+{
+    for(uint32_t i=0; i<mesh->num_vertices; ++i)
+    {
+        const ui_vertex* v = &mesh->vertices[i];
+        if (v->x < x - margin || v->x > x + width + margin || v->y < y - margin || v->y > y + height + margin)
+            return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_mesh(void)
+{
+    static ui_vertex vertices[16384];
+    static uint32_t indices[65536];
+    static ui_draw_call draw_calls[16];
+    ui_mesh mesh = {vertices, indices, draw_calls, 16384, 65536, 16, .aa_fringe = 1.f};
+
+    // sharp box : 4 solid + 4 fringe vertices, 2 triangles + 8 fringe triangles
+    ui_command box = {.type = command_box, .srgb_color = 0xFF0000FF, .data.box = {10.f, 20.f, 100.f, 50.f, 0.f}};
+    CHECK(ui_tessellate(&box, 1, &mesh));
+    CHECK(mesh.num_vertices == 8 && mesh.num_indices == 30 && mesh.num_draw_calls == 1);
+    CHECK(vertices_in_rect(&mesh, 10.f, 20.f, 100.f, 50.f, .5f));
+    CHECK(vertices[0].srgb_color == 0xFF0000FF && vertices[1].srgb_color == 0x000000FF);
+
+    // same without AA
+    mesh.aa_fringe = 0.f;
+    CHECK(ui_tessellate(&box, 1, &mesh));
+    CHECK(mesh.num_vertices == 4 && mesh.num_indices == 6);
+    CHECK(vertices_in_rect(&mesh, 10.f, 20.f, 100.f, 50.f, 0.f));
+    mesh.aa_fringe = 1.f;
+
+    // disc : no duplicated points where the corners meet
+    ui_command disc = {.type = command_box, .srgb_color = 0xFFFFFFFF, .data.box = {0.f, 0.f, 20.f, 20.f, 10.f}};
+    CHECK(ui_tessellate(&disc, 1, &mesh));
+    CHECK(mesh.num_vertices % 8 == 0 && mesh.num_indices == (mesh.num_vertices/2 - 2) * 3 + mesh.num_vertices * 3);
+    CHECK(vertices_in_rect(&mesh, 0.f, 0.f, 20.f, 20.f, .6f));    // fringe vertices are slightly mitered on curves
+    for(uint32_t i=0; i<mesh.num_vertices; i+=2)
+        CHECK(fabsf(hypotf(vertices[i].x - 10.f, vertices[i].y - 10.f) - 9.5f) < .3f);
+
+    // line
+    ui_command line = {.type = command_line, .srgb_color = 0xFFFFFFFF, .data.line = {0.f, 0.f, 10.f, 10.f, 2.f}};
+    CHECK(ui_tessellate(&line, 1, &mesh));
+    CHECK(mesh.num_vertices == 8 && mesh.num_indices == 30);
+
+    // too small arrays
+    ui_mesh small = mesh;
+    small.max_vertices = 4;
+    CHECK(!ui_tessellate(&box, 1, &small));
+
+    // widgets from test.c : one draw call for the window frame, one for the clipped content
+    ui_context* ctx = create_context(1<<16);
+    ui_begin_frame(ctx, 1.f/60.f);
+    build_widgets(ctx);
+    ui_end_frame(ctx);
+
+    uint32_t num_commands;
+    const ui_command* commands = ui_get_commands(ctx, &num_commands);
+    CHECK(num_commands > 0);
+    CHECK(ui_tessellate(commands, num_commands, &mesh));
+    CHECK(mesh.num_draw_calls == 2);
+    CHECK(mesh.num_indices % 3 == 0);
+
+    uint32_t total_indices = 0;
+    for(uint32_t i=0; i<mesh.num_draw_calls; ++i)
+    {
+        CHECK(draw_calls[i].index_offset == total_indices);
+        total_indices += draw_calls[i].index_count;
+    }
+    CHECK(total_indices == mesh.num_indices);
+    CHECK(draw_calls[1].clip_min_x == 816 && draw_calls[1].clip_max_x == 1384);
+
+    bool valid_indices = true;
+    for(uint32_t i=0; i<mesh.num_indices; ++i)
+        valid_indices &= indices[i] < mesh.num_vertices;
+    CHECK(valid_indices);
+    CHECK(vertices_in_rect(&mesh, 800.f, 100.f, 600.f, 1600.f, .6f));
+
+    // each primitive stays within its bounds, the stream is the sum of the primitives
+    uint32_t total_vertices = mesh.num_vertices;
+    uint32_t sum_vertices = 0;
+    for(uint32_t i=0; i<num_commands; ++i)
+    {
+        const ui_command* cmd = &commands[i];
+        CHECK(ui_tessellate(cmd, 1, &mesh));
+        sum_vertices += mesh.num_vertices;
+
+        if (cmd->type == command_box)
+            CHECK(vertices_in_rect(&mesh, cmd->data.box.x, cmd->data.box.y, cmd->data.box.width, cmd->data.box.height, .6f));
+        else if (cmd->type == command_text || cmd->type == command_clip_rect)
+            CHECK(mesh.num_vertices == 0);
+    }
+    CHECK(sum_vertices == total_vertices);
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// reference coverage of the rasterizer primitives, per pixel in double precision
+static double reference_coverage(const ui_command* cmd, double px, double py)
+{
+    double d;
+    if (cmd->type == command_box)
+    {
+        double bx = cmd->data.box.width * .5, by = cmd->data.box.height * .5;
+        double radius = fmax(fmin(cmd->data.box.radius, fmin(bx, by)), 0.);
+        double qx = fabs(px - cmd->data.box.x - bx) - bx + radius, qy = fabs(py - cmd->data.box.y - by) - by + radius;
+        d = sqrt(fmax(qx, 0.) * fmax(qx, 0.) + fmax(qy, 0.) * fmax(qy, 0.)) + fmin(fmax(qx, qy), 0.) - radius;
+    }
+    else
+    {
+        double pax = px - cmd->data.line.x0, pay = py - cmd->data.line.y0;
+        double bax = cmd->data.line.x1 - cmd->data.line.x0, bay = cmd->data.line.y1 - cmd->data.line.y0;
+        double h = fmin(fmax((pax * bax + pay * bay) / (bax * bax + bay * bay), 0.), 1.);
+        d = sqrt((pax - bax * h) * (pax - bax * h) + (pay - bay * h) * (pay - bay * h)) - cmd->data.line.width * .5;
+    }
+    return fmin(fmax(.5 - d, 0.), 1.) * (double) (cmd->srgb_color >> 24) / 255.;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void reference_raster(uint32_t* pixels, uint32_t width, uint32_t height, uint32_t stride, const ui_command* commands, uint32_t num_commands)
+{
+    uint32_t clip[4] = {0, 0, width, height};
+    for(uint32_t i=0; i<num_commands; ++i)
+    {
+        const ui_command* cmd = &commands[i];
+        if (cmd->type == command_clip_rect)
+        {
+            clip[0] = cmd->data.clip_rect.min_x; clip[1] = cmd->data.clip_rect.min_y;
+            clip[2] = (cmd->data.clip_rect.max_x < width) ? cmd->data.clip_rect.max_x : width;
+            clip[3] = (cmd->data.clip_rect.max_y < height) ? cmd->data.clip_rect.max_y : height;
+            continue;
+        }
+
+        for(uint32_t y=clip[1]; y<clip[3]; ++y)
+            for(uint32_t x=clip[0]; x<clip[2]; ++x)
+            {
+                double coverage = reference_coverage(cmd, x + .5, y + .5);
+                uint32_t* pixel = &pixels[y * stride + x];
+                uint32_t result = 0;
+                for(uint32_t c=0; c<4; ++c)
+                {
+                    double dst = (double) ((*pixel >> (c * 8)) & 0xFF);
+                    double src = (c < 3) ? (double) ((cmd->srgb_color >> (c * 8)) & 0xFF) : 255.;
+                    result |= (uint32_t) (dst + (src - dst) * coverage + .5) << (c * 8);
+                }
+                *pixel = result;
+            }
+    }
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static float raster_text_width(const char* text, void* user)
+{
+    (void) user;
+    return 8.f * strlen(text);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// the SIMD kernels and the tiles give the pixels of the reference, spans are not multiples of the SIMD width and the
+// primitives cross the edges of the 64 pixels tiles
+void test_raster(void)
+{
+    enum {width = 150, height = 100, stride = 160};
+    static uint32_t pixels[height * stride], expected[height * stride];
+    ui_raster_def def =
+    {
+        .max_commands = 16,
+        .pixels = pixels,
+        .width = width,
+        .height = height,
+        .stride = stride,
+        .text_width = raster_text_width
+    };
+    def.preallocated_buffer = malloc(ui_raster_min_memory_size(&def));
+    ui_raster* raster = ui_raster_init(&def);
+
+    ui_command commands[4] =
+    {
+        {.type = command_box, .srgb_color = 0xFF3080F0, .data.box = {.x = 10.f, .y = 10.f, .width = 37.f, .height = 21.f}},
+        {.type = command_box, .srgb_color = 0xC020E040, .data.box = {.x = 50.3f, .y = 40.6f, .width = 30.f, .height = 40.f, .radius = 8.f}},
+        {.type = command_clip_rect, .data.clip_rect = {.min_x = 0, .min_y = 0, .max_x = 120, .max_y = 90}},
+        {.type = command_line, .srgb_color = 0xFFFFFFFF, .data.line = {.x0 = 5.f, .y0 = 95.f, .x1 = 140.f, .y1 = 20.f, .width = 3.f}},
+    };
+
+    ui_raster_clear(raster, 0xFF000000);
+    ui_raster_commands(raster, commands, 4);
+    for(uint32_t i=0; i<height * stride; ++i)
+        expected[i] = 0xFF000000;
+    reference_raster(expected, width, height, stride, commands, 4);
+
+    uint32_t mismatches = 0;
+    for(uint32_t y=0; y<height; ++y)
+        for(uint32_t x=0; x<width; ++x)
+            for(uint32_t c=0; c<32; c+=8)
+            {
+                int32_t a = (int32_t) ((pixels[y * stride + x] >> c) & 0xFF), b = (int32_t) ((expected[y * stride + x] >> c) & 0xFF);
+                mismatches += (a - b > 1 || b - a > 1);
+            }
+    CHECK(mismatches == 0);
+
+    // square box : exact inside, nothing outside
+    CHECK(pixels[20 * stride + 10] == 0xFF3080F0 && pixels[20 * stride + 46] == 0xFF3080F0 && pixels[30 * stride + 30] == 0xFF3080F0);
+    CHECK(pixels[20 * stride + 9] == 0xFF000000 && pixels[20 * stride + 47] == 0xFF000000 && pixels[31 * stride + 30] == 0xFF000000);
+
+    // rounded box : translucent, the corner is not filled
+    CHECK(pixels[60 * stride + 65] != 0xFF000000 && pixels[60 * stride + 65] != 0xC020E040);
+    CHECK(pixels[41 * stride + 51] == 0xFF000000);
+
+    // the line stops at the clip rect
+    uint32_t outside = 0, inside = 0;
+    for(uint32_t y=0; y<height; ++y)
+        for(uint32_t x=0; x<width; ++x)
+        {
+            bool clipped = x >= 120 || y >= 90;
+            outside += clipped && pixels[y * stride + x] != 0xFF000000;
+            inside += !clipped && pixels[y * stride + x] == 0xFFFFFFFF;
+        }
+    CHECK(outside == 0 && inside > 100);
+
+    // unchanged pixels after the last column
+    CHECK(pixels[50 * stride + width] == 0);
+    free(def.preallocated_buffer);
+
+    // 10 tiles and bins for 2 x 8 commands : two boxes covering every tile are rasterized in two batches
+    ui_raster_def wide_def = {.max_commands = 2, .pixels = pixels, .width = 640, .height = 16, .stride = 640, .text_width = raster_text_width};
+    wide_def.preallocated_buffer = malloc(ui_raster_min_memory_size(&wide_def));
+    raster = ui_raster_init(&wide_def);
+    ui_command wide_commands[2] =
+    {
+        {.type = command_box, .srgb_color = 0xFF3080F0, .data.box = {.x = 0.f, .y = 0.f, .width = 640.f, .height = 16.f}},
+        {.type = command_box, .srgb_color = 0x80FFFFFF, .data.box = {.x = 2.f, .y = 2.f, .width = 636.f, .height = 12.f}},
+    };
+    ui_raster_clear(raster, 0xFF000000);
+    ui_raster_commands(raster, wide_commands, 2);
+    for(uint32_t i=0; i<640 * 16; ++i)
+        expected[i] = 0xFF000000;
+    reference_raster(expected, 640, 16, 640, wide_commands, 2);
+
+    mismatches = 0;
+    for(uint32_t i=0; i<640 * 16; ++i)
+        for(uint32_t c=0; c<32; c+=8)
+        {
+            int32_t a = (int32_t) ((pixels[i] >> c) & 0xFF), b = (int32_t) ((expected[i] >> c) & 0xFF);
+            mismatches += (a - b > 1 || b - a > 1);
+        }
+    CHECK(mismatches == 0 && pixels[8 * 640 + 600] != 0xFF3080F0 && pixels[600] == 0xFF3080F0);
+
+    free(wide_def.preallocated_buffer);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_window_id(void)
+{
+    CHECK(UI_ID("Alright let's play!") == ui_id("Alright let's play!"));
+    CHECK(UI_ID("") == ui_id(""));
+
+    // same window found by name or by id, the position is kept between frames
+    ui_context* ctx = create_context(1<<16);
+    for(uint32_t frame=0; frame<2; ++frame)
+    {
+        ui_begin_frame(ctx, 1.f/60.f);
+        for(uint32_t i=0; i<16; ++i)
+        {
+            static char names[16][8];
+            snprintf(names[i], sizeof(names[i]), "w%u", i);
+            if (frame == 0)
+                ui_begin_window(ctx, names[i], 10.f * i, 0.f, 100.f, 100.f, 0);
+            else
+                ui_begin_window_id(ctx, ui_id(names[i]), names[i], 0.f, 0.f, 100.f, 100.f, 0);
+
+            CHECK(ui_get_layout(ctx)->x == 10.f * i + 16.f);
+            ui_end_window(ctx);
+        }
+        ui_end_frame(ctx);
+    }
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_culling(void)
+{
+    ui_context* ctx = create_context(1<<16);
+    bool toggles[64] = {0};
+
+    // 64 toggles in a window showing only a few of them
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "culling", 0.f, 0.f, 400.f, 300.f, 0);
+    float start_y = ui_get_layout(ctx)->y;
+    for(uint32_t i=0; i<64; ++i)
+        ui_toggle(ctx, "toggle", &toggles[i]);
+    float end_y = ui_get_layout(ctx)->y;
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+
+    uint32_t num_commands;
+    ui_get_commands(ctx, &num_commands);
+
+    uint32_t culled = ui_get_culled_widgets(ctx);
+    CHECK(culled > 50 && culled < 64);
+    CHECK(end_y - start_y == 64 * 48.f);    // layout advanced for all the rows
+    CHECK(num_commands == 6 + (64 - culled) * 3);
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_list(void)
+{
+    ui_context* ctx = create_context(1<<16);
+    const uint32_t num_items = 100000;
+
+    for(uint32_t frame=0; frame<3; ++frame)
+    {
+        // second frame scrolls down 2 wheel steps (6 rows), third frame tries to scroll above the top
+        ui_update_mouse_pos(ctx, 100.f, 100.f);
+        ui_update_mouse_wheel(ctx, (frame == 1) ? -2.f : (frame == 2) ? 10.f : 0.f);
+        ui_begin_frame(ctx, 1.f/60.f);
+        ui_begin_window(ctx, "list", 0.f, 0.f, 400.f, 600.f, window_scrollable);
+
+        float start_y = ui_get_layout(ctx)->y;
+        uint32_t first = UINT32_MAX, count = 0, index;
+        ui_list_begin(ctx, num_items, 0.f);
+        while (ui_list_next(ctx, &index))
+        {
+            if (first == UINT32_MAX)
+                first = index;
+            CHECK(ui_get_layout(ctx)->y == start_y + index * 48.f);
+            ui_value(ctx, "item", "%u", index);
+            count++;
+        }
+        CHECK(ui_get_layout(ctx)->y == start_y + num_items * 48.f);
+        ui_end_window(ctx);
+        ui_end_frame(ctx);
+
+        CHECK(count > 0 && count <= 12);
+        CHECK(first == ((frame == 1) ? 6 : 0));
+        CHECK(ui_get_culled_widgets(ctx) == 0);
+    }
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// records a frame with a single value widget and returns the text of the value
+enum value_type {value_float, value_int, value_printf};
+
+static const char* format_value(ui_context* ctx, enum value_type type, float value, uint32_t precision, const char* unit)
+{
+    static char text[256];
+
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "format", 0.f, 0.f, 800.f, 300.f, 0);
+    if (type == value_float)
+        ui_value_float(ctx, "value", value, precision, unit);
+    else if (type == value_int)
+        ui_value_int(ctx, "value", (int32_t) value, unit);
+    else
+        ui_value(ctx, "value", "%.*f", (int) precision, value);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+
+    uint32_t num_commands;
+    const ui_command* commands = ui_get_commands(ctx, &num_commands);
+    text[0] = 0;
+    for(uint32_t i=0; i<num_commands; ++i)
+        if (commands[i].type == command_text)
+            snprintf(text, sizeof(text), "%.*s", (int) commands[i].data.text.length, commands[i].data.text.text);
+    return text;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_format(void)
+{
+    ui_context* ctx = create_context(1<<16);
+
+    CHECK(strcmp(format_value(ctx, value_float, 3.14159f, 2, NULL), "3.14") == 0);
+    CHECK(strcmp(format_value(ctx, value_float, 16.f, 2, " ms"), "16.00 ms") == 0);
+    CHECK(strcmp(format_value(ctx, value_float, 0.f, 0, NULL), "0") == 0);
+    CHECK(strcmp(format_value(ctx, value_float, -0.001f, 2, NULL), "-0.00") == 0);
+    CHECK(strcmp(format_value(ctx, value_float, 1234567.f, 1, "km"), "1234567.0km") == 0);
+    CHECK(strcmp(format_value(ctx, value_float, 9.995f, 2, NULL), "9.99") == 0);       // 9.995f is 9.99499...
+    CHECK(strcmp(format_value(ctx, value_float, 0.5f, 0, NULL), "0") == 0);            // exact ties round to even
+    CHECK(strcmp(format_value(ctx, value_float, 1.5f, 0, NULL), "2") == 0);
+    CHECK(strcmp(format_value(ctx, value_float, 0.125f, 2, NULL), "0.12") == 0);
+    CHECK(strcmp(format_value(ctx, value_float, 0.1f, 12, NULL), "0.100000001") == 0); // precision clamped to 9
+    CHECK(strcmp(format_value(ctx, value_float, 1e20f, 1, NULL), "100000002004087734272.0") == 0);
+    CHECK(strcmp(format_value(ctx, value_float, INFINITY, 2, NULL), "inf") == 0);
+    CHECK(strcmp(format_value(ctx, value_float, -INFINITY, 2, NULL), "-inf") == 0);
+    CHECK(strcmp(format_value(ctx, value_float, NAN, 2, NULL), "nan") == 0);
+
+    CHECK(strcmp(format_value(ctx, value_int, 0.f, 0, NULL), "0") == 0);
+    CHECK(strcmp(format_value(ctx, value_int, 42.f, 0, " fps"), "42 fps") == 0);
+    CHECK(strcmp(format_value(ctx, value_int, -2147483648.f, 0, NULL), "-2147483648") == 0);
+
+    // same output as printf on random values
+    uint32_t seed = 12345;
+    for(uint32_t i=0; i<2000; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        float value = ((float)(seed >> 8) / (float)(1 << 24) - .5f) * powf(10.f, (float)(i % 12) - 3.f);
+        uint32_t precision = i % 7;
+        char expected[256];
+        strcpy(expected, format_value(ctx, value_printf, value, precision, NULL));
+        CHECK(strcmp(format_value(ctx, value_float, value, precision, NULL), expected) == 0);
+    }
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// records a frame with two toggles, returns the x of the thumbs and the track rects
+static void toggles_frame(ui_context* ctx, bool* toggles, ui_rect* tracks, float* thumbs_x)
+{
+    ui_begin_frame(ctx, .05f);
+    ui_begin_window(ctx, "toggles", 0.f, 0.f, 400.f, 300.f, 0);
+    ui_toggle(ctx, "first", &toggles[0]);
+    ui_toggle(ctx, "second", &toggles[1]);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+
+    // the track of a toggle is two font heights wide, followed by the thumb
+    uint32_t num_commands, count = 0;
+    const ui_command* commands = ui_get_commands(ctx, &num_commands);
+    for(uint32_t i=0; i+1<num_commands && count<2; ++i)
+    {
+        if (commands[i].type == command_box && commands[i].data.box.width == 64.f && commands[i].data.box.height == 32.f)
+        {
+            tracks[count] = (ui_rect) {commands[i].data.box.x, commands[i].data.box.y, commands[i].data.box.width, commands[i].data.box.height};
+            thumbs_x[count++] = commands[i+1].data.box.x;
+        }
+    }
+    CHECK(count == 2);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_animations(void)
+{
+    ui_context* ctx = create_context(1<<16);
+    bool toggles[2] = {false, false};
+    ui_rect tracks[2];
+    float thumbs_x[2];
+
+    toggles_frame(ctx, toggles, tracks, thumbs_x);
+
+    // click on the first toggle then on the second one the next frame
+    for(uint32_t i=0; i<2; ++i)
+    {
+        ui_update_mouse_pos(ctx, tracks[i].x + tracks[i].width * .5f, tracks[i].y + tracks[i].height * .5f);
+        ui_update_mouse_button(ctx, button_pressed);
+        toggles_frame(ctx, toggles, tracks, thumbs_x);
+        ui_update_mouse_button(ctx, button_released);
+    }
+
+    // both transitions are running
+    toggles_frame(ctx, toggles, tracks, thumbs_x);
+    CHECK(toggles[0] && toggles[1]);
+    for(uint32_t i=0; i<2; ++i)
+        CHECK(thumbs_x[i] > tracks[i].x + 3.f && thumbs_x[i] < tracks[i].x + 29.f);
+
+    // and finished after the duration of the animation
+    for(uint32_t frame=0; frame<4; ++frame)
+        toggles_frame(ctx, toggles, tracks, thumbs_x);
+    for(uint32_t i=0; i<2; ++i)
+        CHECK(fabsf(thumbs_x[i] - (tracks[i].x + 29.f)) <= 1.f);
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static double fake_time(void)
+{
+    static double time = 0.0;
+    return time += .001;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_stats(void)
+{
+    ui_context* ctx = create_context(1<<16);
+    bool toggle = false;
+    float distance = 5.f;
+
+    // same frame twice, to check the counters are reset
+    for(uint32_t frame=0; frame<2; ++frame)
+    {
+        ui_begin_frame(ctx, 1.f/60.f);
+        ui_begin_window(ctx, "first", 0.f, 0.f, 400.f, 300.f, 0);
+        ui_toggle(ctx, "toggle", &toggle);
+        ui_value(ctx, "value", "%d", 1234);
+        ui_value_float(ctx, "float", 1.5f, 2, " ms");
+        ui_end_window(ctx);
+        ui_begin_window(ctx, "second", 400.f, 0.f, 400.f, 300.f, 0);
+        ui_slider(ctx, "distance", 0.f, 10.f, 1.f, &distance, "%.0fkm");
+        ui_end_window(ctx);
+        ui_end_frame(ctx);
+    }
+
+    uint32_t num_commands, count[4] = {0};
+    const ui_command* commands = ui_get_commands(ctx, &num_commands);
+    for(uint32_t i=0; i<num_commands; ++i)
+        count[commands[i].type]++;
+
+    const ui_frame_stats* stats = ui_get_frame_stats(ctx);
+    CHECK(stats->draw_box == count[command_box] && stats->draw_text == count[command_text]);
+    CHECK(stats->draw_line == count[command_line] && stats->set_clip_rect == count[command_clip_rect]);
+    CHECK(stats->text_width == 0);                          // everything is in the cache after the first frame
+    CHECK(stats->bytes_formatted == 4 + 7 + 3);             // "1234", "1.50 ms", "5km"
+    CHECK(stats->widgets == 4 && stats->culled_widgets == 0);
+    CHECK(stats->num_windows == 2);
+    CHECK(strcmp(stats->windows[0].name, "first") == 0 && stats->windows[0].widgets == 3);
+    CHECK(strcmp(stats->windows[1].name, "second") == 0 && stats->windows[1].widgets == 1);
+    CHECK(stats->windows[0].build_time == 0.f);             // no timer
+    free(ctx);
+
+    // with a timer
+    size_t context_size = (ui_min_memory_size() + 7) & ~(size_t)7;
+    uint8_t* buffer = (uint8_t*) malloc(context_size + (1<<16));
+    ui_def def =
+    {
+        .preallocated_buffer = buffer,
+        .font_height = 32.f,
+        .renderer_callbacks = {.text_width = text_width},
+        .command_buffer = buffer + context_size,
+        .command_buffer_size = 1<<16,
+        .get_time = fake_time
+    };
+    ctx = ui_init(&def);
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "timed", 0.f, 0.f, 400.f, 300.f, 0);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+    CHECK(fabsf(ui_get_frame_stats(ctx)->windows[0].build_time - .001f) < 1e-6f);
+    free(buffer);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+typedef struct
+{
+    bool toggle;
+    uint32_t selected;
+    float distance, drive;
+} replay_state;
+
+static size_t replay_frame(ui_context* ctx, replay_state* state, char* dump, size_t size)
+{
+    const char* list[] = {"One", "Two", "Three"};
+    ui_begin_window(ctx, "replay", 0.f, 0.f, 400.f, 600.f, window_resizable);
+    ui_toggle(ctx, "toggle", &state->toggle);
+    ui_segmented(ctx, list, 3, &state->selected);
+    ui_slider_float(ctx, "distance", 0.f, 100.f, 1.f, &state->distance, 1, "km");
+    ui_knob(ctx, "drive", 0.f, 10.f, 2.f, &state->drive);
+    ui_newline(ctx);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+
+    uint32_t num_commands;
+    const ui_command* commands = ui_get_commands(ctx, &num_commands);
+    return ui_dump_commands(commands, num_commands, dump, size);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_replay(void)
+{
+    const uint32_t num_frames = 200;
+    const size_t dump_size = 1<<20;
+    char* dumps[2] = {(char*) malloc(dump_size), (char*) malloc(dump_size)};
+    size_t dump_length[2] = {0, 0};
+    replay_state states[2] = {{.distance = 50.f, .drive = 5.f}, {.distance = 50.f, .drive = 5.f}};
+    uint8_t stream[8192];
+
+    // records a session of clicks and drags sweeping the window
+    ui_context* ctx = create_context(1<<16);
+    ui_recorder recorder;
+    ui_recorder_init(&recorder, ctx, stream, sizeof(stream));
+    for(uint32_t frame=0; frame<num_frames; ++frame)
+    {
+        ui_recorder_mouse_pos(&recorder, 20.f + (float)(frame % 20) * 19.f, 60.f + (float)(frame / 20) * 24.f);
+        if (frame % 3 == 0)
+            ui_recorder_mouse_button(&recorder, button_pressed);
+        else if (frame % 3 == 2)
+            ui_recorder_mouse_button(&recorder, button_released);
+        ui_recorder_begin_frame(&recorder, 1.f/60.f);
+        dump_length[0] += replay_frame(ctx, &states[0], dumps[0] + dump_length[0], dump_size - dump_length[0]);
+    }
+    CHECK(!recorder.overflow);
+    free(ctx);
+
+    // replays it in a new context
+    ctx = create_context(1<<16);
+    ui_replayer replayer;
+    CHECK(ui_replayer_init(&replayer, stream, recorder.offset));
+    while (ui_replayer_next_frame(&replayer, ctx, 0.f))
+        dump_length[1] += replay_frame(ctx, &states[1], dumps[1] + dump_length[1], dump_size - dump_length[1]);
+    free(ctx);
+
+    CHECK(replayer.frame_index == num_frames);
+    CHECK(dump_length[0] < dump_size && dump_length[0] == dump_length[1]);
+    CHECK(memcmp(dumps[0], dumps[1], dump_length[0]) == 0);
+    CHECK(memcmp(&states[0], &states[1], sizeof(replay_state)) == 0);
+    CHECK(states[0].toggle || states[0].selected != 0 || states[0].distance != 50.f);
+
+    // too small buffer
+    ctx = create_context(1<<16);
+    ui_recorder_init(&recorder, ctx, stream, 16);
+    ui_recorder_mouse_pos(&recorder, 1.f, 1.f);
+    CHECK(recorder.overflow && recorder.offset == 8);
+    CHECK(!ui_replayer_init(&replayer, "not a stream", 12));
+    free(ctx);
+
+    free(dumps[0]);
+    free(dumps[1]);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void merge_window(ui_context* ctx, const char* name, float x, float* value)
+{
+    ui_begin_window(ctx, name, x, 0.f, 400.f, 300.f, 0);
+    ui_value_float(ctx, name, *value, 2, NULL);
+    ui_slider(ctx, "slider", 0.f, 10.f, 0.f, value, "%.1f");
+    ui_end_window(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// two windows built in two contexts then merged must give the same commands as a single context
+void test_merge(void)
+{
+    ui_context* single = create_context(1<<16);
+    ui_context* main_ctx = create_context(1<<16);
+    ui_context* workers[2] = {create_context(1<<16), create_context(1<<16)};
+    float single_values[2] = {2.f, 8.f}, worker_values[2] = {2.f, 8.f};
+    char dumps[2][8192];
+
+    for(uint32_t frame=0; frame<3; ++frame)
+    {
+        // click on the slider track of the second window
+        ui_update_mouse_pos(single, 700.f, 170.f);
+        ui_update_mouse_pos(main_ctx, 700.f, 170.f);
+        ui_update_mouse_button(single, (frame == 1) ? button_pressed : button_idle);
+        ui_update_mouse_button(main_ctx, (frame == 1) ? button_pressed : button_idle);
+
+        ui_begin_frame(single, 1.f/60.f);
+        merge_window(single, "first", 0.f, &single_values[0]);
+        merge_window(single, "second", 400.f, &single_values[1]);
+        ui_end_frame(single);
+
+        for(uint32_t i=0; i<2; ++i)
+        {
+            ui_copy_input(workers[i], main_ctx);
+            ui_begin_frame(workers[i], 1.f/60.f);
+            merge_window(workers[i], (i == 0) ? "first" : "second", 400.f * i, &worker_values[i]);
+            ui_end_frame(workers[i]);
+        }
+
+        ui_begin_frame(main_ctx, 1.f/60.f);
+        ui_merge_commands(main_ctx, workers[0]);
+        ui_merge_commands(main_ctx, workers[1]);
+        ui_end_frame(main_ctx);
+
+        uint32_t num_commands[2];
+        const ui_command* commands[2] = {ui_get_commands(single, &num_commands[0]), ui_get_commands(main_ctx, &num_commands[1])};
+        CHECK(num_commands[0] == num_commands[1]);
+        for(uint32_t i=0; i<2; ++i)
+            CHECK(ui_dump_commands(commands[i], num_commands[i], dumps[i], sizeof(dumps[i])) < sizeof(dumps[i]));
+        CHECK(strcmp(dumps[0], dumps[1]) == 0);
+    }
+
+    CHECK(single_values[1] != 8.f && single_values[1] == worker_values[1]);
+
+    free(single);
+    free(main_ctx);
+    free(workers[0]);
+    free(workers[1]);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// returns the index of the first text command equal to [text] or UINT32_MAX
+static uint32_t find_text(const ui_command* commands, uint32_t num_commands, const char* text)
+{
+    for(uint32_t i=0; i<num_commands; ++i)
+        if (commands[i].type == command_text && strcmp(commands[i].data.text.text, text) == 0)
+            return i;
+    return UINT32_MAX;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// "left" and "right" overlap, each one built in its own context
+static const ui_command* merge_zorder_frame(ui_context* main_ctx, ui_context** workers, bool* toggles, enum ui_button_state button,
+                                            float x, float y, uint32_t* num_commands)
+{
+    ui_update_mouse_pos(main_ctx, x, y);
+    ui_update_mouse_button(main_ctx, button);
+    for(uint32_t i=0; i<2; ++i)
+    {
+        ui_copy_input(workers[i], main_ctx);
+        ui_begin_frame(workers[i], 1.f/60.f);
+        ui_begin_window(workers[i], (i == 0) ? "left" : "right", 200.f * i, 0.f, 400.f, 300.f, 0);
+        ui_toggle(workers[i], (i == 0) ? "a" : "b", &toggles[i]);
+        ui_end_window(workers[i]);
+        ui_end_frame(workers[i]);
+    }
+
+    ui_begin_frame(main_ctx, 1.f/60.f);
+    ui_merge_commands(main_ctx, workers[0]);
+    ui_merge_commands(main_ctx, workers[1]);
+    ui_end_frame(main_ctx);
+    return ui_get_commands(main_ctx, num_commands);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// the merged windows take part in the z order of the main context, only the topmost of all the contexts gets the mouse
+void test_merge_zorder(void)
+{
+    ui_context* main_ctx = create_context(1<<16);
+    ui_context* workers[2] = {create_context(1<<16), create_context(1<<16)};
+    bool toggles[2] = {false, false};
+    uint32_t num_commands;
+
+    merge_zorder_frame(main_ctx, workers, toggles, button_idle, 0.f, 0.f, &num_commands);
+    const ui_command* commands = merge_zorder_frame(main_ctx, workers, toggles, button_idle, 0.f, 0.f, &num_commands);
+    uint32_t track = find_text(commands, num_commands, "a") + 1;
+    CHECK(commands[track].type == command_box && commands[track].data.box.x > 200.f);
+    float track_x = commands[track].data.box.x + 10.f, track_y = commands[track].data.box.y + 10.f;
+
+    // the toggle of "left" is under "right"
+    merge_zorder_frame(main_ctx, workers, toggles, button_pressed, track_x, track_y, &num_commands);
+    merge_zorder_frame(main_ctx, workers, toggles, button_released, track_x, track_y, &num_commands);
+    CHECK(!toggles[0] && !toggles[1]);
+
+    // a click on the visible part of "left" brings it to the front, then its toggle gets the click
+    merge_zorder_frame(main_ctx, workers, toggles, button_pressed, 100.f, 200.f, &num_commands);
+    commands = merge_zorder_frame(main_ctx, workers, toggles, button_released, 100.f, 200.f, &num_commands);
+    CHECK(find_text(commands, num_commands, "left") > find_text(commands, num_commands, "right"));
+    merge_zorder_frame(main_ctx, workers, toggles, button_pressed, track_x, track_y, &num_commands);
+    CHECK(toggles[0] && !toggles[1]);
+
+    free(main_ctx);
+    free(workers[0]);
+    free(workers[1]);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void zorder_frame(ui_context* ctx, bool* toggles, enum ui_button_state button, float x, float y)
+{
+    ui_update_mouse_pos(ctx, x, y);
+    ui_update_mouse_button(ctx, button);
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "back", 0.f, 0.f, 400.f, 300.f, 0);
+    ui_toggle(ctx, "toggle", &toggles[0]);
+    ui_end_window(ctx);
+    ui_begin_window(ctx, "front", 200.f, 0.f, 400.f, 300.f, 0);
+    ui_toggle(ctx, "other", &toggles[1]);
+    ui_end_window(ctx);
+    ui_begin_window(ctx, "hidden", 250.f, 100.f, 100.f, 100.f, 0);
+    ui_toggle(ctx, "toggle", &toggles[2]);
+    ui_end_window(ctx);
+    ui_begin_window(ctx, "cover", 200.f, 50.f, 200.f, 200.f, 0);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_zorder(void)
+{
+    ui_context* ctx = create_context(1<<16);
+    bool toggles[3] = {false, false, false};
+    uint32_t num_commands;
+    const ui_command* commands;
+
+    // the toggle of "back" is under "front"
+    zorder_frame(ctx, toggles, button_idle, 0.f, 0.f);
+    zorder_frame(ctx, toggles, button_idle, 0.f, 0.f);
+    commands = ui_get_commands(ctx, &num_commands);
+    uint32_t track = find_text(commands, num_commands, "toggle") + 1;
+    CHECK(commands[track].type == command_box && commands[track].data.box.x > 200.f);
+    float track_x = commands[track].data.box.x + 10.f, track_y = commands[track].data.box.y + 10.f;
+
+    // "hidden" is fully covered by "cover", nothing is drawn since the second frame
+    CHECK(find_text(commands, num_commands, "hidden") == UINT32_MAX);
+    CHECK(ui_get_culled_widgets(ctx) == 1);
+
+    zorder_frame(ctx, toggles, button_pressed, track_x, track_y);
+    zorder_frame(ctx, toggles, button_released, track_x, track_y);
+    CHECK(!toggles[0] && !toggles[1]);
+
+    // a click on the visible part of "back" brings it to the front, its commands are drawn last
+    zorder_frame(ctx, toggles, button_pressed, 100.f, 200.f);
+    zorder_frame(ctx, toggles, button_released, 100.f, 200.f);
+    commands = ui_get_commands(ctx, &num_commands);
+    CHECK(find_text(commands, num_commands, "back") > find_text(commands, num_commands, "cover"));
+    CHECK(find_text(commands, num_commands, "front") < find_text(commands, num_commands, "cover"));
+    CHECK(commands[num_commands - 1].type == command_clip_rect);
+
+    // now the toggle receives the click
+    zorder_frame(ctx, toggles, button_pressed, track_x, track_y);
+    CHECK(toggles[0] && !toggles[1] && !toggles[2]);
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// immediate mode renderer counting the texts drawn, the user pointer is an array of two counters
+static void count_draw_box(float x, float y, float width, float height, float radius, uint32_t srgb_color, void* user)
+{
+    (void) x; (void) y; (void) width; (void) height; (void) radius; (void) srgb_color; (void) user;
+}
+
+static void count_draw_text(float x, float y, const char* text, uint32_t srgb_color, void* user)
+{
+    (void) x; (void) y; (void) srgb_color;
+    ((uint32_t*) user)[strcmp(text, "small") == 0]++;
+}
+
+static void count_draw_line(float x0, float y0, float x1, float y1, float width, uint32_t srgb_color, void* user)
+{
+    (void) x0; (void) y0; (void) x1; (void) y1; (void) width; (void) srgb_color; (void) user;
+}
+
+static void count_set_clip_rect(uint16_t min_x, uint16_t min_y, uint16_t max_x, uint16_t max_y, void* user)
+{
+    (void) min_x; (void) min_y; (void) max_x; (void) max_y; (void) user;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// "small" is called after "big" and drawn over it
+static void immediate_zorder_frame(ui_context* ctx, bool* toggles, enum ui_button_state button, float x, float y)
+{
+    ui_update_mouse_pos(ctx, x, y);
+    ui_update_mouse_button(ctx, button);
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "big", 0.f, 0.f, 400.f, 300.f, 0);
+    ui_toggle(ctx, "toggle", &toggles[0]);
+    ui_end_window(ctx);
+    ui_begin_window(ctx, "small", 20.f, 40.f, 300.f, 200.f, 0);
+    ui_toggle(ctx, "toggle", &toggles[1]);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// with the renderer callbacks the stacking order is the call order, a click does not change it
+void test_immediate_zorder(void)
+{
+    uint32_t texts[2] = {0, 0};
+    void* buffer = malloc(ui_min_memory_size());
+    ui_def def =
+    {
+        .preallocated_buffer = buffer,
+        .font_height = 32.f,
+        .renderer_callbacks = {count_draw_box, count_draw_text, count_draw_line, count_set_clip_rect, text_width, texts}
+    };
+    ui_context* ctx = ui_init(&def);
+    bool toggles[2] = {false, false};
+
+    immediate_zorder_frame(ctx, toggles, button_idle, 0.f, 0.f);
+    immediate_zorder_frame(ctx, toggles, button_idle, 0.f, 0.f);
+    CHECK(texts[1] == 2);
+
+    // a click on "big" around "small", then on "small" : "small" is still drawn and takes the click
+    immediate_zorder_frame(ctx, toggles, button_pressed, 390.f, 290.f);
+    immediate_zorder_frame(ctx, toggles, button_released, 390.f, 290.f);
+    immediate_zorder_frame(ctx, toggles, button_idle, 390.f, 290.f);
+    CHECK(texts[1] == 5);
+
+    immediate_zorder_frame(ctx, toggles, button_pressed, 270.f, 120.f);
+    CHECK(texts[1] == 6 && toggles[1] && !toggles[0]);
+
+    free(buffer);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// proportional font : the glyphs are 'a' + 1 pixels wide, the pixels contain the codepoint
+static bool glyph_metrics(uint32_t codepoint, ui_glyph_metrics* metrics, void* user)
+{
+    (void) user;
+    if (codepoint < 'a' || codepoint > 'z')
+        return false;
+
+    *metrics = (ui_glyph_metrics) {.width = (float)(codepoint - 'a' + 1), .height = 10.f, .offset_y = 2.f, .advance = (float)(codepoint - 'a' + 2)};
+    return true;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void rasterize_glyph(uint32_t codepoint, uint8_t* pixels, uint32_t stride, void* user)
+{
+    (void) user;
+    for(uint32_t y=0; y<10; ++y)
+        memset(pixels + y * stride, (int) codepoint, codepoint - 'a' + 1);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static float kerning(uint32_t left, uint32_t right, void* user)
+{
+    (void) user;
+    return (left == 'a' && right == 'v') ? -1.f : 0.f;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_text(void)
+{
+    // 8x8 monospace bitmap font from ' ' to '~', 16 glyphs per row, the pixels contain the character
+    static uint8_t font_pixels[128 * 48];
+    for(uint32_t i=0; i<sizeof(font_pixels); ++i)
+        font_pixels[i] = (uint8_t) (' ' + (i / (128 * 8)) * 16 + (i % 128) / 8);
+
+    ui_bitmap_font font = {.pixels = font_pixels, .stride = 128, .cell_width = 8, .cell_height = 8, .columns = 16,
+                           .first_char = ' ', .num_chars = 95};
+    ui_text_def def = {.atlas_width = 64, .atlas_height = 64, .max_glyphs = 32, .max_runs = 16, .max_run_glyphs = 64,
+                       .max_quads = 64, .bitmap_font = &font};
+    def.preallocated_buffer = malloc(ui_text_min_memory_size(&def));
+    ui_text_cache* text = ui_text_init(&def);
+    uint32_t width, height, num_quads, hits, misses;
+    bool dirty;
+
+    CHECK(ui_text_width(text, "abc") == 24.f);
+    ui_text_draw(text, 10.f, 20.f, "abc", 0xff00ff00);
+    const ui_text_quad* quads = ui_text_get_quads(text, &num_quads);
+    CHECK(num_quads == 3);
+    CHECK(quads[1].x0 == 18.f && quads[1].x1 == 26.f && quads[1].y0 == 20.f && quads[1].y1 == 28.f);
+    CHECK(quads[2].srgb_color == 0xff00ff00);
+
+    // the atlas contains the glyphs pointed by the uv
+    const uint8_t* atlas = ui_text_get_atlas(text, &width, &height, &dirty);
+    CHECK(width == 64 && height == 64 && dirty);
+    for(uint32_t i=0; i<num_quads; ++i)
+    {
+        uint32_t x = (uint32_t) (quads[i].u0 * width), y = (uint32_t) (quads[i].v0 * height);
+        CHECK(atlas[y * width + x] == 'a' + i && atlas[(y + 7) * width + x + 7] == 'a' + i);
+        CHECK(quads[i].u1 - quads[i].u0 == 8.f / width);
+    }
+
+    // the width and the second draw come from the cache, no new glyph
+    ui_text_draw(text, 0.f, 0.f, "abc", 0xffffffff);
+    ui_text_get_stats(text, &hits, &misses);
+    CHECK(hits == 2 && misses == 1);
+    ui_text_get_atlas(text, &width, &height, &dirty);
+    CHECK(!dirty);
+
+    // missing glyphs are skipped, a new frame resets the quads
+    ui_text_begin_frame(text);
+    CHECK(ui_text_width(text, "a\x01" "b") == 16.f);
+    ui_text_draw(text, 0.f, 0.f, "a\x01" "b", 0xffffffff);
+    ui_text_get_quads(text, &num_quads);
+    CHECK(num_quads == 2);
+
+    // same hash and same length, the content selects the run
+    ui_text_begin_frame(text);
+    CHECK(ui_text_width(text, "declinate") == 72.f);
+    ui_text_draw(text, 0.f, 0.f, "declinate", 0xffffffff);
+    ui_text_draw(text, 0.f, 0.f, "macallums", 0xffffffff);
+    quads = ui_text_get_quads(text, &num_quads);
+    CHECK(num_quads == 18);
+    for(uint32_t i=0; i<num_quads; ++i)
+    {
+        uint32_t x = (uint32_t) (quads[i].u0 * width), y = (uint32_t) (quads[i].v0 * height);
+        CHECK(atlas[y * width + x] == (uint8_t) ((i < 9) ? "declinate"[i] : "macallums"[i - 9]));
+    }
+
+    // callbacks and kerning, spaces have no quad
+    ui_text_def callbacks_def = def;
+    callbacks_def.bitmap_font = NULL;
+    callbacks_def.glyph_metrics = glyph_metrics;
+    callbacks_def.rasterize_glyph = rasterize_glyph;
+    callbacks_def.kerning = kerning;
+    text = ui_text_init(&callbacks_def);
+    CHECK(ui_text_width(text, "av") == 2.f - 1.f + ('v' - 'a' + 2));
+    ui_text_draw(text, 0.f, 0.f, "a v", 0xffffffff);
+    quads = ui_text_get_quads(text, &num_quads);
+    CHECK(num_quads == 2 && quads[1].x0 == 2.f && quads[1].x1 == 2.f + ('v' - 'a' + 1) && quads[1].y0 == 2.f);
+
+    // the renderer callbacks answer from the same cache
+    ui_renderer_fnc_t renderer = ui_text_renderer(text);
+    CHECK(renderer.text_width("av", renderer.user) == ui_text_width(text, "av"));
+    renderer.draw_text(5.f, 5.f, "z", 0xffffffff, renderer.user);
+    ui_text_get_quads(text, &num_quads);
+    CHECK(num_quads == 3);
+
+    free(def.preallocated_buffer);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static float counting_text_width(const char* text, void* user)
+{
+    (*(uint32_t*) user)++;
+    return 16.f * strlen(text);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static const char* text_cache_title = "w";
+
+static void text_cache_frame(ui_context* ctx, const char** labels, uint32_t num_labels)
+{
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, text_cache_title, 0.f, 0.f, 400.f, 600.f, 0);
+    for(uint32_t i=0; i<num_labels; ++i)
+        ui_button(ctx, labels[i], align_left);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_text_width_cache(void)
+{
+    uint32_t num_measures = 0, hits, misses;
+    uint8_t* buffer = (uint8_t*) malloc(ui_min_memory_size() + (1<<16));
+    ui_def def =
+    {
+        .preallocated_buffer = buffer,
+        .font_height = 16.f,
+        .renderer_callbacks = {.text_width = counting_text_width, .user = &num_measures},
+        .command_buffer = buffer + ((ui_min_memory_size() + 7) & ~(size_t)7),
+        .command_buffer_size = (1<<16) - 8
+    };
+    ui_context* ctx = ui_init(&def);
+
+    // the window title is measured at the creation of the window, then hits when it is centered every frame
+    text_cache_frame(ctx, NULL, 0);
+    ui_get_text_cache_stats(ctx, &hits, &misses);
+    CHECK(num_measures == 1 && hits == 1 && misses == 1);
+
+    // same pointer and same content : measured once, then hits
+    static char label[16] = "one";
+    const char* labels[5] = {label};
+    text_cache_frame(ctx, labels, 1);
+    text_cache_frame(ctx, labels, 1);
+    ui_get_text_cache_stats(ctx, &hits, &misses);
+    CHECK(num_measures == 2 && hits == 4 && misses == 2);
+
+    // string_buffer case : the content behind the same pointer changes
+    strcpy(label, "three");
+    text_cache_frame(ctx, labels, 1);
+    ui_get_text_cache_stats(ctx, &hits, &misses);
+    CHECK(num_measures == 3 && hits == 5 && misses == 3);
+
+    // same content and same address bits select the same set, see measure_text : the texts have the content of the
+    // title but not its address bits, the title is not in their set
+    static char texts[512][8];
+    uintptr_t title = (uintptr_t) text_cache_title;
+    uint32_t num_texts = 0;
+    for(uint32_t i=0; i<512 && num_texts<5; ++i)
+    {
+        uintptr_t address = (uintptr_t) texts[i];
+        if ((((address >> 3) ^ (address >> 11)) & 31) == ((((title >> 3) ^ (title >> 11)) + 1) & 31))
+        {
+            strcpy(texts[i], "w");
+            labels[num_texts++] = texts[i];
+        }
+    }
+    CHECK(num_texts == 5);
+
+    // a full set replaces the entry used the longest time ago : the fifth text takes the place of the fourth
+    text_cache_frame(ctx, labels, 4);
+    const char* recent[4] = {labels[0], labels[1], labels[2], labels[4]};
+    text_cache_frame(ctx, recent, 4);
+    CHECK(num_measures == 3 + 5);
+    text_cache_frame(ctx, recent, 4);
+    CHECK(num_measures == 3 + 5);
+    text_cache_frame(ctx, labels + 3, 1);
+    CHECK(num_measures == 3 + 6);
+
+    // the invalidation forces a new measure of every text, the title included
+    ui_invalidate_text_cache(ctx);
+    text_cache_frame(ctx, recent, 4);
+    CHECK(num_measures == 3 + 6 + 5);
+    text_cache_frame(ctx, recent, 4);
+    CHECK(num_measures == 3 + 6 + 5);
+
+    free(buffer);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static void dirty_frame(ui_context* ctx, bool* toggles, float* value, float x, float y)
+{
+    ui_update_mouse_pos(ctx, x, y);
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "dirty", 0.f, 0.f, 400.f, 600.f, 0);
+    ui_toggle(ctx, "first", &toggles[0]);
+    ui_slider_float(ctx, "slider", 0.f, 100.f, 0.f, value, 1, NULL);
+    ui_toggle(ctx, "second", &toggles[1]);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_dirty_rects(void)
+{
+    const size_t command_buffer_size = 1 << 16;
+    size_t context_size = (ui_min_memory_size() + 7) & ~(size_t)7;
+    uint8_t* buffer = (uint8_t*) malloc(context_size + command_buffer_size);
+    ui_def def =
+    {
+        .preallocated_buffer = buffer,
+        .font_height = 32.f,
+        .renderer_callbacks = {.text_width = text_width},
+        .command_buffer = buffer + context_size,
+        .command_buffer_size = command_buffer_size,
+        .track_dirty_rects = true
+    };
+    ui_context* ctx = ui_init(&def);
+    bool toggles[2] = {false, true};
+    float value = 50.f;
+    uint32_t num_rects, num_commands;
+
+    // the first frame is all new, the second one is idle
+    dirty_frame(ctx, toggles, &value, 1000.f, 1000.f);
+    const ui_rect* rects = ui_get_dirty_rects(ctx, &num_rects);
+    CHECK(num_rects == 1 && rects[0].x == 0.f && rects[0].y == 0.f && rects[0].width == 400.f && rects[0].height == 600.f);
+    dirty_frame(ctx, toggles, &value, 1000.f, 1000.f);
+    ui_get_dirty_rects(ctx, &num_rects);
+    CHECK(num_rects == 0);
+
+    // rows of the toggles and thumb of the slider
+    const ui_command* commands = ui_get_commands(ctx, &num_commands);
+    float first_bottom = commands[find_text(commands, num_commands, "first")].data.text.y + 48.f;
+    float second_top = commands[find_text(commands, num_commands, "second")].data.text.y;
+    const ui_command* thumb = &commands[find_text(commands, num_commands, "slider") + 3];
+    CHECK(thumb->type == command_box);
+    float thumb_x = thumb->data.box.x + thumb->data.box.width * .5f, thumb_y = thumb->data.box.y + thumb->data.box.height * .5f;
+
+    // grab and drag the thumb, only the slider rows change
+    ui_update_mouse_button(ctx, button_pressed);
+    dirty_frame(ctx, toggles, &value, thumb_x, thumb_y);
+    dirty_frame(ctx, toggles, &value, thumb_x + 50.f, thumb_y);
+    CHECK(value > 50.f);
+    rects = ui_get_dirty_rects(ctx, &num_rects);
+    CHECK(num_rects == 1 && rects[0].y >= first_bottom && rects[0].y + rects[0].height <= second_top);
+
+    // the thumb is drawn at its new position one frame later, then nothing changes while the mouse does not move
+    dirty_frame(ctx, toggles, &value, thumb_x + 50.f, thumb_y);
+    dirty_frame(ctx, toggles, &value, thumb_x + 50.f, thumb_y);
+    ui_get_dirty_rects(ctx, &num_rects);
+    CHECK(num_rects == 0);
+
+    // a toggle animates its row, the slider is released first
+    ui_update_mouse_button(ctx, button_released);
+    dirty_frame(ctx, toggles, &value, 1000.f, 1000.f);
+    dirty_frame(ctx, toggles, &value, 1000.f, 1000.f);
+    const ui_command* track = &commands[find_text(commands, num_commands, "second") + 1];
+    ui_update_mouse_button(ctx, button_pressed);
+    dirty_frame(ctx, toggles, &value, track->data.box.x + 4.f, track->data.box.y + 4.f);
+    CHECK(!toggles[1]);
+    rects = ui_get_dirty_rects(ctx, &num_rects);
+    CHECK(num_rects == 1 && rects[0].y >= second_top - 1.f && rects[0].y + rects[0].height <= second_top + 48.f + 1.f);
+
+    free(buffer);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_idle(void)
+{
+    ui_context* ctx = create_context(1<<16);
+    bool toggles[2] = {false, false};
+    float value = 50.f, next_wakeup;
+
+    // idle as soon as the frame following the last input is built
+    dirty_frame(ctx, toggles, &value, 1000.f, 1000.f);
+    CHECK(!ui_is_idle(ctx, &next_wakeup) && next_wakeup == 0.f);
+    dirty_frame(ctx, toggles, &value, 1000.f, 1000.f);
+    CHECK(ui_is_idle(ctx, &next_wakeup) && next_wakeup > 1e30f);
+
+    // a click on a toggle starts a tween, the ui stays busy until its end
+    uint32_t num_commands;
+    const ui_command* commands = ui_get_commands(ctx, &num_commands);
+    const ui_command* track = &commands[find_text(commands, num_commands, "first") + 1];
+    ui_update_mouse_button(ctx, button_pressed);
+    dirty_frame(ctx, toggles, &value, track->data.box.x + 4.f, track->data.box.y + 4.f);
+    ui_update_mouse_button(ctx, button_released);
+    CHECK(toggles[0] && !ui_is_idle(ctx, NULL));
+
+    uint32_t busy_frames = 0;
+    for(; busy_frames < 100 && !ui_is_idle(ctx, NULL); ++busy_frames)
+        dirty_frame(ctx, toggles, &value, 1000.f, 1000.f);
+    CHECK(busy_frames >= 12 && busy_frames < 15);
+
+    // dragging keeps the ui busy even if the mouse does not move
+    const ui_command* thumb = &commands[find_text(commands, num_commands, "slider") + 3];
+    float thumb_x = thumb->data.box.x + thumb->data.box.width * .5f, thumb_y = thumb->data.box.y + thumb->data.box.height * .5f;
+    ui_update_mouse_button(ctx, button_pressed);
+    for(uint32_t i=0; i<3; ++i)
+        dirty_frame(ctx, toggles, &value, thumb_x, thumb_y);
+    CHECK(!ui_is_idle(ctx, &next_wakeup) && next_wakeup == 0.f);
+    ui_update_mouse_button(ctx, button_released);
+    dirty_frame(ctx, toggles, &value, thumb_x, thumb_y);
+    dirty_frame(ctx, toggles, &value, thumb_x, thumb_y);
+    CHECK(ui_is_idle(ctx, NULL));
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// two sliders on integers through a temporary float, identified by the address of the integers
+static void keys_frame(ui_context* ctx, int32_t* values, float x, float y)
+{
+    ui_update_mouse_pos(ctx, x, y);
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "keys", 0.f, 0.f, 400.f, 600.f, 0);
+    for(uint32_t i=0; i<2; ++i)
+    {
+        float value = (float) values[i];
+        ui_set_widget_key(ctx, &values[i]);
+        ui_slider_float(ctx, "slider", 0.f, 100.f, 1.f, &value, 0, NULL);
+        values[i] = (int32_t) value;
+    }
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_widget_key(void)
+{
+    ui_context* ctx = create_context(1<<16);
+    int32_t values[2] = {50, 50};
+    uint32_t num_commands;
+
+    keys_frame(ctx, values, 1000.f, 1000.f);
+    const ui_command* commands = ui_get_commands(ctx, &num_commands);
+    const ui_command* thumb = &commands[find_text(commands, num_commands, "slider") + 3];
+    float thumb_x = thumb->data.box.x + thumb->data.box.width * .5f, thumb_y = thumb->data.box.y + thumb->data.box.height * .5f;
+
+    // only the first slider is dragged
+    ui_update_mouse_button(ctx, button_pressed);
+    keys_frame(ctx, values, thumb_x, thumb_y);
+    keys_frame(ctx, values, thumb_x + 50.f, thumb_y);
+    CHECK(values[0] > 50 && values[1] == 50);
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static int32_t reference_lerp(uint32_t a, uint32_t b, float t)
+{
+    double ca = (double) a / 255.0, cb = (double) b / 255.0;
+    ca = (ca <= 0.04045) ? ca / 12.92 : pow((ca + 0.055) / 1.055, 2.4);
+    cb = (cb <= 0.04045) ? cb / 12.92 : pow((cb + 0.055) / 1.055, 2.4);
+    double l = ca + (cb - ca) * t;
+    double c = (l <= 0.0031308) ? l * 12.92 : 1.055 * pow(l, 1.0 / 2.4) - 0.055;
+    return (int32_t) (c * 255.0 + .5);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_color_lerp(void)
+{
+    ui_context* ctx = create_context(1<<16);
+
+    // the middle of black and white is 188 in sRGB, alpha is linear
+    CHECK(ui_color_lerp(ctx, 0xFF000000, 0xFFFFFFFF, .5f) == 0xFFBCBCBC);
+    CHECK(ui_color_lerp(ctx, 0xFFFFFFFF, 0xFF000000, .5f) == 0xFFBCBCBC);
+    CHECK(ui_color_lerp(ctx, 0xFF000000, 0xFFFFFFFF, .25f) == 0xFF898989);
+    CHECK(ui_color_lerp(ctx, 0x00000000, 0xFF000000, .5f) == 0x80000000);
+    CHECK(ui_color_lerp(ctx, 0xFF800010, 0xFF0000FF, .75f) == 0xFF4200E1);
+    CHECK(ui_color_lerp(ctx, 0x12345678, 0x9ABCDEF0, -1.f) == 0x12345678);
+    CHECK(ui_color_lerp(ctx, 0x12345678, 0x9ABCDEF0, 2.f) == 0x9ABCDEF0);
+
+    // every channel value goes through the tables unchanged
+    uint32_t round_trip_errors = 0;
+    for(uint32_t i=0; i<256; ++i)
+    {
+        uint32_t color = i | (i << 8) | (i << 16) | (i << 24);
+        round_trip_errors += (ui_color_lerp(ctx, color, color, .5f) != color);
+    }
+    CHECK(round_trip_errors == 0);
+
+    // at most one step away from the exact conversion
+    int32_t max_error = 0;
+    for(uint32_t a=0; a<256; a+=15)
+        for(uint32_t b=0; b<256; b+=15)
+            for(float t=.125f; t<1.f; t+=.125f)
+            {
+                int32_t error = abs((int32_t) (ui_color_lerp(ctx, a, b, t) & 0xFF) - reference_lerp(a, b, t));
+                max_error = (error > max_error) ? error : max_error;
+            }
+    CHECK(max_error <= 1);
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static const char* bank_labels[10] = {"k0", "k1", "k2", "k3", "k4", "k5", "k6", "k7", "k8", "k9"};
+
+// 10 knobs in rows of 3, one by one or as a bank
+static void knobs_frame(ui_context* ctx, float* values, bool bank, float x, float y)
+{
+    ui_update_mouse_pos(ctx, x, y);
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "knobs", 0.f, 0.f, 800.f, 600.f, 0);
+    if (bank)
+        ui_knob_bank(ctx, bank_labels, 10, 3, 0.f, 1.f, .5f, values);
+    else
+    {
+        for(uint32_t i=0; i<10; ++i)
+        {
+            ui_knob(ctx, bank_labels[i], 0.f, 1.f, .5f, &values[i]);
+            if (i % 3 == 2 || i == 9)
+                ui_newline(ctx);
+        }
+    }
+    ui_separator(ctx);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_knob_bank(void)
+{
+    ui_context* single = create_context(1<<16);
+    ui_context* bank = create_context(1<<16);
+    float single_values[10], bank_values[10];
+    for(uint32_t i=0; i<10; ++i)
+        single_values[i] = bank_values[i] = (float) i / 9.f;
+
+    // same primitives, the value marks are read from a table
+    knobs_frame(single, single_values, false, 1000.f, 1000.f);
+    knobs_frame(bank, bank_values, true, 1000.f, 1000.f);
+    uint32_t num_single, num_bank, mismatches = 0;
+    const ui_command* single_commands = ui_get_commands(single, &num_single);
+    const ui_command* commands = ui_get_commands(bank, &num_bank);
+    CHECK(num_single == num_bank);
+    for(uint32_t i=0; i<num_single && i<num_bank; ++i)
+    {
+        const ui_command* a = &single_commands[i];
+        const ui_command* b = &commands[i];
+        if (a->type != b->type || a->srgb_color != b->srgb_color)
+            mismatches++;
+        else if (a->type == command_box)
+            mismatches += fabsf(a->data.box.x - b->data.box.x) > 1e-3f || fabsf(a->data.box.y - b->data.box.y) > 1e-3f ||
+                          a->data.box.width != b->data.box.width || a->data.box.radius != b->data.box.radius;
+        else if (a->type == command_line)
+            mismatches += fabsf(a->data.line.x1 - b->data.line.x1) > .5f || fabsf(a->data.line.y1 - b->data.line.y1) > .5f;
+        else if (a->type == command_text)
+            mismatches += strcmp(a->data.text.text, b->data.text.text) != 0 || a->data.text.x != b->data.text.x || a->data.text.y != b->data.text.y;
+    }
+    CHECK(mismatches == 0);
+
+    // dragging the center of the fifth knob up only changes its value
+    const ui_command* mark = &commands[find_text(commands, num_bank, "k4") - 1];
+    float x = mark->data.line.x0, y = mark->data.line.y0;
+    ui_update_mouse_button(bank, button_pressed);
+    knobs_frame(bank, bank_values, true, x, y);
+    knobs_frame(bank, bank_values, true, x, y - 40.f);
+    ui_update_mouse_button(bank, button_released);
+    knobs_frame(bank, bank_values, true, x, y - 40.f);
+    uint32_t changed = 0;
+    for(uint32_t i=0; i<10; ++i)
+        changed += (bank_values[i] != (float) i / 9.f);
+    CHECK(changed == 1 && bank_values[4] > 4.f / 9.f);
+
+    // only the visible rows are drawn
+    static float many_values[3000];
+    ui_begin_frame(bank, 1.f/60.f);
+    ui_begin_window(bank, "many", 0.f, 0.f, 800.f, 600.f, 0);
+    float start_y = ui_get_layout(bank)->y;
+    ui_knob_bank(bank, NULL, 3000, 3, 0.f, 1.f, .5f, many_values);
+    float end_y = ui_get_layout(bank)->y;
+    ui_end_window(bank);
+    ui_end_frame(bank);
+    commands = ui_get_commands(bank, &num_bank);
+    CHECK(end_y - start_y == 1000 * 96.f);
+    CHECK(num_bank < 6 + 7 * 3 * 5);
+
+    // each knob counts as a widget in the stats, as with ui_knob
+    uint32_t num_drawn = 0;
+    for(uint32_t i=0; i<num_bank; ++i)
+        num_drawn += (commands[i].type == command_line);
+    const ui_frame_stats* stats = ui_get_frame_stats(bank);
+    CHECK(num_drawn > 0 && stats->widgets == 3000 && stats->culled_widgets == 3000 - num_drawn);
+    CHECK(stats->windows[0].widgets == 3000 && ui_get_culled_widgets(bank) == 3000 - num_drawn);
+
+    free(single);
+    free(bank);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// knob on a float, or on an integer through a float copy written back rounded as ui::knob<int> in lean_ui.hpp
+static void int_knob_frame(ui_context* ctx, float* float_value, int* int_value, float x, float y)
+{
+    ui_update_mouse_pos(ctx, x, y);
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "knobs", 0.f, 0.f, 400.f, 600.f, 0);
+    if (float_value != NULL)
+        ui_knob(ctx, "knob", 0.f, 10.f, 5.f, float_value);
+    else
+    {
+        float edited = (float) *int_value, original = edited;
+        ui_set_widget_key(ctx, int_value);
+        ui_knob(ctx, "knob", 0.f, 10.f, 5.f, &edited);
+        if (edited != original)
+            *int_value = (int) lroundf(edited);
+    }
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// the same slow drag gives the same value when the caller rounds it at each frame
+void test_int_knob(void)
+{
+    ui_context* ctx = create_context(1<<16);
+    float float_value = 5.f;
+    int int_value = 5;
+
+    // no double click on the first press
+    for(uint32_t frame=0; frame<20; ++frame)
+        int_knob_frame(ctx, &float_value, NULL, 1000.f, 1000.f);
+    uint32_t num_commands;
+    const ui_command* commands = ui_get_commands(ctx, &num_commands);
+    const ui_command* mark = &commands[find_text(commands, num_commands, "knob") - 1];
+    CHECK(mark->type == command_line);
+    float x = mark->data.line.x0, y = mark->data.line.y0;
+
+    for(uint32_t pass=0; pass<2; ++pass)
+    {
+        float* f = (pass == 0) ? &float_value : NULL;
+        ui_update_mouse_button(ctx, button_pressed);
+        int_knob_frame(ctx, f, &int_value, x, y);
+        for(uint32_t step=1; step<=59; ++step)
+            int_knob_frame(ctx, f, &int_value, x, y - 2.f * (float) step);
+        ui_update_mouse_button(ctx, button_released);
+        int_knob_frame(ctx, f, &int_value, x, y - 118.f);
+    }
+    // the button is released out of the window, the value does not move
+    CHECK(float_value > 7.5f && float_value < 8.5f);
+    CHECK(int_value == (int) lroundf(float_value));
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static const ui_command* plot_frame(ui_context* ctx, const ui_plot_data* data, uint32_t* num_commands)
+{
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "plot", 0.f, 0.f, 400.f, 600.f, 0);
+    ui_plot(ctx, "plot", data, 0.f, 1.f, 0.f);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+    return ui_get_commands(ctx, num_commands);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_plot(void)
+{
+    ui_context* ctx = create_context(1<<16);
+    uint32_t num_commands;
+
+    // fewer samples than pixels : segments
+    float few[3] = {0.f, 1.f, .5f};
+    ui_plot_data data = {.samples = few, .capacity = 3, .first = 0, .count = 3};
+    const ui_command* commands = plot_frame(ctx, &data, &num_commands);
+    uint32_t first_line = 0;
+    while (first_line < num_commands && commands[first_line].type != command_line)
+        first_line++;
+    CHECK(first_line + 2 < num_commands && commands[first_line + 1].type == command_line);
+    if (first_line + 2 < num_commands)
+    {
+        const ui_command* line = &commands[first_line];
+        CHECK(line[0].data.line.y1 < line[0].data.line.y0 && line[0].data.line.x1 == line[1].data.line.x0);
+        CHECK(line[1].data.line.y1 == (line[0].data.line.y0 + line[0].data.line.y1) * .5f);
+    }
+
+    // a spike reaches the top of one column only
+    enum {capacity = 1 << 17, block_size = 8};
+    static float samples[capacity];
+    samples[1234] = 1.f;
+    data = (ui_plot_data) {.samples = samples, .capacity = capacity, .first = 1000, .count = capacity};
+    commands = plot_frame(ctx, &data, &num_commands);
+    float top = FLT_MAX;
+    uint32_t num_columns = 0, at_top = 0;
+    for(uint32_t i=0; i<num_commands; ++i)
+        if (commands[i].type == command_box && commands[i].data.box.width == 1.f)
+        {
+            top = fminf(top, commands[i].data.box.y);
+            num_columns++;
+        }
+    for(uint32_t i=0; i<num_commands; ++i)
+        at_top += (commands[i].type == command_box && commands[i].data.box.width == 1.f && commands[i].data.box.y == top);
+    CHECK(num_columns > 200 && num_columns < 400 && at_top == 1);
+
+    // the summary gives the same columns, also after writing samples. The columns cover both levels.
+    static float min_values[capacity / block_size + capacity / (block_size * block_size)];
+    static float max_values[capacity / block_size + capacity / (block_size * block_size)];
+    CHECK(ui_plot_summary_size(capacity, block_size) == sizeof(min_values) / sizeof(float));
+    static ui_command raw[1024];
+    ui_plot_summary summary = {.min_values = min_values, .max_values = max_values, .block_size = block_size};
+    for(uint32_t i=0; i<capacity; ++i)
+        samples[i] = (float) ((i * 2654435761u) >> 16 & 0xFFFF) / 65535.f;
+    ui_plot_summary_update(&summary, samples, capacity, 0, capacity);
+
+    uint32_t mismatches = 0;
+    for(uint32_t update=0; update<3; ++update)
+    {
+        data.summary = NULL;
+        commands = plot_frame(ctx, &data, &num_commands);
+        uint32_t num_raw = (num_commands < 1024) ? num_commands : 1024;
+        memcpy(raw, commands, num_raw * sizeof(ui_command));
+
+        data.summary = &summary;
+        commands = plot_frame(ctx, &data, &num_commands);
+        mismatches += (num_commands != num_raw);
+        for(uint32_t i=0; i<num_raw && i<num_commands; ++i)
+            mismatches += (commands[i].type == command_box && memcmp(&commands[i].data.box, &raw[i].data.box, sizeof(raw[i].data.box)) != 0);
+
+        // streaming : 700 new samples replace the oldest ones
+        for(uint32_t i=0; i<700; ++i)
+            samples[(data.first + i) % capacity] = (float) (update * 700 + i) / 2100.f;
+        ui_plot_summary_update(&summary, samples, capacity, data.first, 700);
+        data.first = (data.first + 700) % capacity;
+    }
+    CHECK(mismatches == 0);
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// boxes of the chart, after the 2 boxes of its background
+static uint32_t chart_boxes(const ui_command* commands, uint32_t num_commands, const ui_command** boxes, uint32_t max_boxes)
+{
+    uint32_t first = find_text(commands, num_commands, "chart");
+    uint32_t background = first;
+    while (background > 0 && commands[background - 1].type == command_box)
+        background--;
+
+    uint32_t count = 0;
+    for(uint32_t i=background + 2; i<first && count<max_boxes; ++i)
+        boxes[count++] = &commands[i];
+    return count;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_histogram(void)
+{
+    ui_context* ctx = create_context(1<<16);
+
+    // values outside of the range are in the first and last bins
+    const float values[8] = {-1.f, 0.f, .24f, .25f, .5f, .99f, 1.f, 2.f};
+    uint32_t bins[4] = {0};
+    ui_histogram_bin(values, 8, 0.f, 1.f, bins, 4);
+    CHECK(bins[0] == 3 && bins[1] == 1 && bins[2] == 1 && bins[3] == 3);
+
+    static float ramp[1000];
+    uint32_t ramp_bins[4] = {0};
+    for(uint32_t i=0; i<1000; ++i)
+        ramp[i] = (float) i / 1000.f;
+    ui_histogram_bin(ramp, 1000, 0.f, 1.f, ramp_bins, 4);
+    CHECK(ramp_bins[0] == 250 && ramp_bins[1] == 250 && ramp_bins[2] == 250 && ramp_bins[3] == 250);
+
+    // the two bins with the same count are one bar
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "histogram", 0.f, 0.f, 400.f, 600.f, 0);
+    ui_histogram(ctx, "chart", bins, 4, 0.f);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+
+    uint32_t num_commands;
+    const ui_command* commands = ui_get_commands(ctx, &num_commands);
+    const ui_command* bars[8];
+    uint32_t num_bars = chart_boxes(commands, num_commands, bars, 8);
+    CHECK(num_bars == 3);
+    if (num_bars == 3)
+    {
+        CHECK(bars[1]->data.box.width == bars[0]->data.box.width * 2.f);
+        CHECK(bars[1]->data.box.height * 3.f == bars[0]->data.box.height && bars[2]->data.box.height == bars[0]->data.box.height);
+    }
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_heatmap(void)
+{
+    ui_context* ctx = create_context(1<<16);
+
+    // the cells at the minimum are the background, the runs of the same color are merged
+    static float cells[3][300];
+    const float first_row[8] = {0.f, 0.f, 1.f, 1.f, 1.f, .5f, .5f, 0.f};
+    memcpy(cells[0], first_row, sizeof(first_row));
+    for(uint32_t i=8; i<16; ++i)
+        cells[0][i] = 1.f;
+    for(uint32_t i=0; i<300; ++i)
+        cells[1][i] = cells[2][i] = 1.f;
+
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "heatmap", 0.f, 0.f, 400.f, 600.f, 0);
+    ui_heatmap(ctx, "chart", &cells[0][0], 8, 2, 0.f, 1.f, 0.f);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+
+    uint32_t num_commands;
+    const ui_command* commands = ui_get_commands(ctx, &num_commands);
+    const ui_command* boxes[8];
+    uint32_t num_boxes = chart_boxes(commands, num_commands, boxes, 8);
+    CHECK(num_boxes == 3);
+    if (num_boxes == 3)
+    {
+        // 3 cells at the max, 2 in the middle, then the full second row
+        CHECK(boxes[0]->data.box.width * 2.f == boxes[1]->data.box.width * 3.f);
+        CHECK(boxes[2]->data.box.width * 3.f == boxes[0]->data.box.width * 8.f);
+        CHECK(boxes[0]->srgb_color == boxes[2]->srgb_color && boxes[1]->srgb_color != boxes[0]->srgb_color);
+        CHECK(boxes[2]->data.box.y > boxes[0]->data.box.y);
+    }
+
+    // a row longer than a quantization chunk is still one box
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "heatmap", 0.f, 0.f, 400.f, 600.f, 0);
+    ui_heatmap(ctx, "chart", &cells[1][0], 300, 2, 0.f, 1.f, 0.f);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+    commands = ui_get_commands(ctx, &num_commands);
+    CHECK(chart_boxes(commands, num_commands, boxes, 8) == 2);
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+#define TABLE_ROWS (1100)
+static int32_t table_values[TABLE_ROWS];
+
+static const char* table_cell(uint32_t row, uint32_t column, void* user)
+{
+    static char buffer[32];
+    (void) user;
+    if (column == 0)
+        snprintf(buffer, sizeof(buffer), "row %u", row);
+    else
+        snprintf(buffer, sizeof(buffer), "%d", table_values[row]);
+    return buffer;
+}
+
+static int table_compare(uint32_t row_a, uint32_t row_b, uint32_t column, void* user)
+{
+    (void) user;
+    if (column == 0)
+        return (row_a > row_b) - (row_a < row_b);
+    return (table_values[row_a] > table_values[row_b]) - (table_values[row_a] < table_values[row_b]);
+}
+
+static bool table_sorted(const ui_table_data* table)
+{
+    for(uint32_t i=1; i<table->num_rows; ++i)
+    {
+        int result = table_compare(table->order[i - 1], table->order[i], (uint32_t) table->sort_column, NULL);
+        if (table->descending)
+            result = -result;
+        if (result > 0 || (result == 0 && table->order[i - 1] > table->order[i]))
+            return false;
+    }
+    return true;
+}
+
+static const ui_command* table_frame(ui_context* ctx, ui_table_data* table, float x, float y, uint32_t* num_commands)
+{
+    ui_update_mouse_pos(ctx, x, y);
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "table", 0.f, 0.f, 400.f, 600.f, window_scrollable);
+    ui_table(ctx, table);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+    return ui_get_commands(ctx, num_commands);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+// the table and a second window on its right
+static void table_other_frame(ui_context* ctx, ui_table_data* table, float x, float y)
+{
+    ui_update_mouse_pos(ctx, x, y);
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "table", 0.f, 0.f, 400.f, 600.f, window_scrollable);
+    ui_table(ctx, table);
+    ui_end_window(ctx);
+    ui_begin_window(ctx, "other", 500.f, 0.f, 300.f, 300.f, 0);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_table(void)
+{
+    ui_context* ctx = create_context(1<<16);
+    static uint32_t order[TABLE_ROWS];
+    ui_table_column columns[2] = {{"name", 150.f}, {"value", 100.f}};
+    ui_table_data table = {.columns = columns, .num_columns = 2, .num_rows = 1000, .order = order, .sort_column = -1,
+                           .cell_text = table_cell, .compare_rows = table_compare};
+    for(uint32_t i=0; i<TABLE_ROWS; ++i)
+        table_values[i] = (int32_t) ((i * 7919) % 1000);
+
+    // only the visible rows, one clip rect per column
+    uint32_t num_commands, num_texts = 0, num_clips = 0;
+    const ui_command* commands = table_frame(ctx, &table, 1000.f, 1000.f, &num_commands);
+    for(uint32_t i=0; i<num_commands; ++i)
+    {
+        num_texts += (commands[i].type == command_text);
+        num_clips += (commands[i].type == command_clip_rect);
+    }
+    CHECK(num_texts > 20 && num_texts < 40);
+    CHECK(num_clips == 2 + 2 + 1);      // window, columns, restore, end of the window
+    uint32_t first_row = find_text(commands, num_commands, "row 0");
+    CHECK(first_row < num_commands && commands[first_row - 1].type == command_text);
+    CHECK(order[0] == 0 && order[999] == 999);
+
+    // a click on a header sorts, a second click reverses
+    const ui_command* header = &commands[find_text(commands, num_commands, "value")];
+    float header_x = header->data.text.x + 10.f, header_y = header->data.text.y + 10.f;
+    float edge_x = header->data.text.x - 4.f;
+    ui_update_mouse_button(ctx, button_pressed);
+    table_frame(ctx, &table, header_x, header_y, &num_commands);
+    ui_update_mouse_button(ctx, button_released);
+    table_frame(ctx, &table, header_x, header_y, &num_commands);
+    CHECK(table.sort_column == 1 && !table.descending && table_sorted(&table));
+
+    ui_update_mouse_button(ctx, button_pressed);
+    table_frame(ctx, &table, header_x, header_y, &num_commands);
+    ui_update_mouse_button(ctx, button_released);
+    CHECK(table.descending && table_sorted(&table));
+
+    // new rows and changed rows are inserted in the order
+    table.num_rows = TABLE_ROWS;
+    table_frame(ctx, &table, 1000.f, 1000.f, &num_commands);
+    CHECK(table.num_sorted == TABLE_ROWS && table_sorted(&table));
+    table_values[500] = 5000;
+    ui_table_row_changed(&table, 500);
+    CHECK(order[0] == 500 && table_sorted(&table));
+
+    // dragging the right edge of the first column
+    ui_update_mouse_button(ctx, button_pressed);
+    table_frame(ctx, &table, edge_x, header_y, &num_commands);
+    table_frame(ctx, &table, edge_x + 50.f, header_y, &num_commands);
+    ui_update_mouse_button(ctx, button_released);
+    table_frame(ctx, &table, edge_x + 50.f, header_y, &num_commands);
+    CHECK(columns[0].width == 200.f && columns[1].width == 100.f && table.sort_column == 1 && table.descending);
+
+    // releasing the drag over another window keeps the width
+    edge_x += 50.f;
+    ui_update_mouse_button(ctx, button_pressed);
+    table_other_frame(ctx, &table, edge_x, header_y);
+    table_other_frame(ctx, &table, edge_x + 30.f, header_y);
+    ui_update_mouse_button(ctx, button_released);
+    table_other_frame(ctx, &table, 600.f, 100.f);
+    CHECK(columns[0].width == 230.f);
+    table_other_frame(ctx, &table, 600.f, 100.f);
+    CHECK(columns[0].width == 230.f);
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static const ui_command* log_frame(ui_context* ctx, ui_log_data* log, float wheel, uint32_t* num_commands)
+{
+    ui_update_mouse_pos(ctx, 100.f, 200.f);
+    ui_update_mouse_wheel(ctx, wheel);
+    ui_begin_frame(ctx, 1.f/60.f);
+    ui_begin_window(ctx, "log", 0.f, 0.f, 400.f, 600.f, 0);
+    ui_log(ctx, log, 400.f);
+    ui_end_window(ctx);
+    ui_end_frame(ctx);
+    return ui_get_commands(ctx, num_commands);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+static uint32_t count_texts(const ui_command* commands, uint32_t num_commands)
+{
+    uint32_t count = 0;
+    for(uint32_t i=0; i<num_commands; ++i)
+        count += (commands[i].type == command_text);
+    return count;
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+void test_log(void)
+{
+    ui_context* ctx = create_context(1<<16);
+    static char text[4096];
+    size_t line_starts[256];
+    ui_log_data log = {.text = text, .line_starts = line_starts, .max_lines = 256};
+
+    size_t length = 0;
+    for(uint32_t i=0; i<10; ++i)
+        length += (size_t) sprintf(text + length, "line %u\n", i);
+    length += (size_t) sprintf(text + length, "crlf\r\n");
+    log.length = length;
+
+    // the trailing empty line is indexed but not shown, '\r' is removed
+    uint32_t num_commands;
+    const ui_command* commands = log_frame(ctx, &log, 0.f, &num_commands);
+    CHECK(log.num_lines == 12 && log.indexed_length == length);
+    CHECK(count_texts(commands, num_commands) == 1 + 11);     // title and lines
+    CHECK(find_text(commands, num_commands, "line 0") != UINT32_MAX && find_text(commands, num_commands, "crlf") != UINT32_MAX);
+
+    // a line without '\n' is shown, completed by the next bytes
+    log.follow_tail = true;
+    length += (size_t) sprintf(text + length, "partial");
+    log.length = length;
+    commands = log_frame(ctx, &log, 0.f, &num_commands);
+    CHECK(find_text(commands, num_commands, "partial") != UINT32_MAX);
+    length += (size_t) sprintf(text + length, " end\n");
+    log.length = length;
+    commands = log_frame(ctx, &log, 0.f, &num_commands);
+    CHECK(find_text(commands, num_commands, "partial end") != UINT32_MAX && log.num_lines == 13);
+
+    // following the tail : only the visible lines are drawn
+    for(uint32_t i=10; i<100; ++i)
+        length += (size_t) sprintf(text + length, "line %u\n", i);
+    log.length = length;
+    commands = log_frame(ctx, &log, 0.f, &num_commands);
+    uint32_t bottom = log.first_line;
+    CHECK(log.num_lines == 103 && bottom == 102 - 11);
+    CHECK(find_text(commands, num_commands, "line 99") != UINT32_MAX && find_text(commands, num_commands, "line 0") == UINT32_MAX);
+    CHECK(count_texts(commands, num_commands) == 1 + 11);
+
+    // the wheel stops following, new lines do not scroll anymore
+    log_frame(ctx, &log, 1.f, &num_commands);
+    CHECK(!log.follow_tail && log.first_line == bottom - 3);
+    length += (size_t) sprintf(text + length, "line 100\n");
+    log.length = length;
+    log_frame(ctx, &log, 0.f, &num_commands);
+    CHECK(log.first_line == bottom - 3);
+    log_frame(ctx, &log, -10.f, &num_commands);
+    CHECK(log.follow_tail && log.first_line == bottom + 1);
+
+    // full index : the oldest half is dropped
+    log.max_lines = 64;
+    log.num_lines = 0;
+    commands = log_frame(ctx, &log, 0.f, &num_commands);
+    CHECK(log.num_lines <= 64 && log.indexed_length == length && line_starts[log.num_lines - 1] == length);
+    CHECK(text[line_starts[0] - 1] == '\n' && strncmp(text + line_starts[log.num_lines - 2], "line 100", 8) == 0);
+    CHECK(log.follow_tail && find_text(commands, num_commands, "line 100") != UINT32_MAX);
+
+    free(ctx);
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------
+int main(void)
+{
+    test_mesh();
+    test_raster();
+    test_window_id();
+    test_culling();
+    test_list();
+    test_format();
+    test_animations();
+    test_stats();
+    test_replay();
+    test_merge();
+    test_zorder();
+    test_immediate_zorder();
+    test_merge_zorder();
+    test_text();
+    test_text_width_cache();
+    test_dirty_rects();
+    test_idle();
+    test_widget_key();
+    test_color_lerp();
+    test_knob_bank();
+    test_int_knob();
+    test_plot();
+    test_histogram();
+    test_heatmap();
+    test_table();
+    test_log();
+
+    if (num_failures == 0)
+        fprintf(stdout, "all tests passed\n");
+
+    return (num_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}